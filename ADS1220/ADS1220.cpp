@@ -10,12 +10,18 @@
 
 #include "mbed.h"
 #include "ADS1220.h"
+#include "ADS1220Config.h"
 #include <inttypes.h>
 
-ADS1220::ADS1220(PinName mosi, PinName miso, PinName sclk,PinName cs):
-    _device(mosi, miso, sclk),nCS_(cs)
+ADS1220::ADS1220(PinName mosi, PinName miso, PinName sclk,PinName cs,PinName drdy):
+    _device(mosi, miso, sclk),nCS_(cs),drdy_(drdy),hasDrdy_(drdy != NC),burstUs_(0),queue_(NULL),active_(0),pending_(false),busy_(false),
+    streaming_(false),stamp_(0),overruns_(0),scanCount_(0),scanPos_(0),scanVisit_(0),tag_(0),
+    auxRequest_(0),auxActive_(0),suspect_(false),
+    deferWrites_(false),miso_(miso),doutPort_(NULL),doutMask_(0),directRead_(false),csHeld_(false),drdyOnDout_(false),transactions_(0),
+    busBytes_(0),frequency_(4000000)
 {
-    _device.frequency(4000000);
+    memset(shadow_, 0, sizeof(shadow_));  // power-on register values
+    _device.frequency(frequency_);
     _device.format(8,1);
 }
 
@@ -23,18 +29,22 @@ void ADS1220::AssertCS(bool fAssert)
 {
     if (fAssert)
     {
-        nCS_ = 0;
-        nCS_ = 1;
+        transactions_++;
         nCS_ = 0;
     }
-    else
+    else if (!csHeld_)  // DOUT/DRDY only signals data ready while CS is low
     {
         nCS_ = 1;
     }
 }
 
-// ADS1220 Initial Configuration
+// ADS1220 Initial Configuration, page-59 of paper SBAS501C.pdf, see Config(int, int)
 void ADS1220::Config(void)
+{
+    ADS1220Bridge::Apply(*this);  // registers encoded at compile time
+}
+
+void ADS1220::Config(int DataRate, int Mode)
 {
     unsigned reg;
 
@@ -45,25 +55,62 @@ void ADS1220::Config(void)
     // 02h      98h     External reference (REFP1, REFN1), simultaneous 50-Hz and 60-Hz rejection, PSW = 1
     // 03h      00h     No IDACs used
 
-    ReadRegister(ADS1220_0_REGISTER, 0x01, &reg);
-    reg &= 0x00;  // clear prev value;
-    reg |= (ADS1220_MUX_1_2 | ADS1220_GAIN_128);  //ADS1220_GAIN_128);
-    WriteRegister(ADS1220_0_REGISTER, 0x01, &reg);  // write the register value containing the new value back to the ADS
+    // Staged in the shadow, sent as one 4-register WREG
+    BeginUpdate();
+
+    reg = (ADS1220_MUX_1_2 | ADS1220_GAIN_128);  //ADS1220_GAIN_128);
+    WriteRegister(ADS1220_0_REGISTER, 0x01, &reg);
 
-    ReadRegister(ADS1220_1_REGISTER, 0x01, &reg);
-    reg &= 0x00;
-    reg |= (ADS1220_DR_20 | ADS1220_CC);  // Set default start mode to 20sps and continuous conversions
+    reg = ((DataRate & 0xe0) | (Mode & 0x18) | ADS1220_CC);  // Default 20sps normal mode, continuous conversions
     WriteRegister(ADS1220_1_REGISTER, 0x01, &reg);
 
-    ReadRegister(ADS1220_2_REGISTER, 0x01, &reg);
-    reg &= 0x00;
-    reg |= (ADS1220_VREF_EX_AIN | ADS1220_REJECT_BOTH | ADS1220_PSW_SW);
+    // The 50/60Hz FIR only exists at 20 SPS in normal mode
+    if (DataRate == ADS1220_DR_20 && Mode == ADS1220_MODE_NORMAL)
+        reg = (ADS1220_VREF_EX_AIN | ADS1220_REJECT_BOTH | ADS1220_PSW_SW);
+    else
+        reg = (ADS1220_VREF_EX_AIN | ADS1220_REJECT_OFF | ADS1220_PSW_SW);
     WriteRegister(ADS1220_2_REGISTER, 0x01, &reg);
+
+    reg = 0x00;
+    WriteRegister(ADS1220_3_REGISTER, 0x01, &reg);
+
+    Commit(false);
 }
 
 
+int ADS1220::WaitForDataReady(int Timeout)
+{
+    uint32_t Flags;
+
+    if (!hasDrdy_)
+    {
+        // No DRDY pin: a conversion period plus margin
+        ThisThread::sleep_for(1000 / GetSampleRate() + 2);
+        return ADS1220_NO_ERROR;
+    }
+
+    // DRDY stays low until the result is read, so the level covers an edge before fall()
+    drdyFlags_.clear(ADS1220_FLAG_DRDY);
+    drdy_.fall(callback(this, &ADS1220::OnDrdyEdge));
+    if (drdy_.read() == 0)
+    {
+        drdy_.fall(NULL);
+        return ADS1220_NO_ERROR;
+    }
+
+    Flags = drdyFlags_.wait_any(ADS1220_FLAG_DRDY, Timeout);
+    drdy_.fall(NULL);
+    return (Flags & osFlagsError) ? ADS1220_ERROR : ADS1220_NO_ERROR;
+}
+
+void ADS1220::OnDrdyEdge(void)
+{
+    drdyFlags_.set(ADS1220_FLAG_DRDY);
+}
+
 void ADS1220::SendByte(unsigned char Value)
 {
+    busBytes_++;
     _device.write(Value);
 }
 
@@ -71,6 +118,7 @@ void ADS1220::SendByte(unsigned char Value)
 unsigned int ADS1220::ReceiveByte(void)
 {
     unsigned int readvalue;
+    busBytes_++;
     readvalue = _device.write(0x00);
 
     return readvalue;
@@ -88,6 +136,21 @@ unsigned int ADS1220::ReadData(void)
    // assert CS to start transfer
     AssertCS(true);
 
+   // Continuous mode: the result can be clocked out directly after DRDY
+   if (directRead_)
+   {
+      static const char nop[3] = { 0, 0, 0 };  // DIN low, not a command
+      char rx[3];
+      _device.write(nop, 3, rx, 3);  // exactly 24 SCLKs
+      busBytes_ += 3;
+      AssertCS(false);
+
+      Data = ((uint32_t)(uint8_t)rx[0] << 16) | ((uint32_t)(uint8_t)rx[1] << 8) | (uint8_t)rx[2];
+      if (Data & 0x800000)
+         Data |= 0xff000000;
+      return Data;
+   }
+
    // send the command byte
    SendByte(ADS1220_CMD_RDATA);
       
@@ -115,50 +178,127 @@ unsigned int ADS1220::ReadData(void)
    return Data;
 }
 
+// Served from the shadow; see ReadDeviceRegisters() for the SPI access
 void ADS1220::ReadRegister(int StartAddress, int NumRegs, unsigned * pData)
+{
+   int i;
+
+    for (i=0; i< NumRegs && (StartAddress + i) < 4; i++)
+    {
+        *pData++ = shadow_[StartAddress + i];
+    }
+
+    return;
+}
+
+void ADS1220::ReadDeviceRegisters(unsigned * pData)
 {
    int i;
 
     // assert CS to start transfer
-        AssertCS(true);
-   
-    // send the command byte
-    SendByte(ADS1220_CMD_RREG | (((StartAddress<<2) & 0x0c) |((NumRegs-1)&0x03)));
-   
+    AssertCS(true);
+
+    // send the command byte, all 4 registers from 00h
+    SendByte(ADS1220_CMD_RREG | 0x03);
+
     // get the register content
-    for (i=0; i< NumRegs; i++)
+    for (i=0; i< 4; i++)
     {
         *pData++ = ReceiveByte();
     }
-   
+
     // de-assert CS
-        AssertCS(false);
-    
+    AssertCS(false);
+
     return;
 }
 
 void ADS1220::WriteRegister(int StartAddress, int NumRegs, unsigned * pData)
 {
     int i;
-   
+
+    for (i=0; i< NumRegs && (StartAddress + i) < 4; i++)
+    {
+        shadow_[StartAddress + i] = pData[i] & 0xff;
+    }
+    if (drdyOnDout_)
+        shadow_[3] |= ADS1220_DRDY_MODE;  // the stream waits on the DOUT edge
+
+    // Between BeginUpdate() and Commit() only the shadow changes
+    if (deferWrites_)
+        return;
+
     // assert CS to start transfer
     AssertCS(true);
-   
+
     // send the command byte
     SendByte(ADS1220_CMD_WREG | (((StartAddress<<2) & 0x0c) |((NumRegs-1)&0x03)));
-   
+
     // send the data bytes
-    for (i=0; i< NumRegs; i++)
+    for (i=0; i< NumRegs && (StartAddress + i) < 4; i++)
     {
-        SendByte(*pData++);
+        SendByte(shadow_[StartAddress + i]);
     }
-   
+
     // de-assert CS
     AssertCS(false);
-   
+
     return;
 }
 
+void ADS1220::BeginUpdate(void)
+{
+    deferWrites_ = true;
+}
+
+int ADS1220::Commit(bool DoVerify)
+{
+    int i;
+
+    deferWrites_ = false;
+    if (drdyOnDout_)
+        shadow_[3] |= ADS1220_DRDY_MODE;  // Apply() stages a whole register 3
+
+    // assert CS to start transfer
+    AssertCS(true);
+
+    // one WREG for all 4 registers from 00h
+    SendByte(ADS1220_CMD_WREG | 0x03);
+    for (i=0; i< 4; i++)
+    {
+        SendByte(shadow_[i]);
+    }
+
+    // de-assert CS
+    AssertCS(false);
+
+    return DoVerify ? Verify() : ADS1220_NO_ERROR;
+}
+
+int ADS1220::Apply(uint8_t Reg0, uint8_t Reg1, uint8_t Reg2, uint8_t Reg3, bool DoVerify)
+{
+    shadow_[0] = Reg0;
+    shadow_[1] = Reg1;
+    shadow_[2] = Reg2;
+    shadow_[3] = Reg3;
+    return Commit(DoVerify);
+}
+
+int ADS1220::Verify(void)
+{
+    int i;
+    unsigned readback[4];
+
+    ReadDeviceRegisters(readback);
+    for (i=0; i< 4; i++)
+    {
+        if ((readback[i] & 0xff) != shadow_[i])
+            return ADS1220_ERROR;
+    }
+
+    return ADS1220_NO_ERROR;
+}
+
 void ADS1220::SendResetCommand(void)
 {
     // assert CS to start transfer
@@ -166,6 +306,7 @@ void ADS1220::SendResetCommand(void)
    
     // send the command byte
     SendByte(ADS1220_CMD_RESET);
+    memset(shadow_, 0, sizeof(shadow_));  // all registers back to 00h
    
     // de-assert CS
     AssertCS(false);
@@ -347,6 +488,22 @@ int ADS1220::SetDRDYMode(int DRDYMode)
 register get value commands
 */
 
+int ADS1220::GetSampleRate(void)
+{
+    static const uint16_t Rates[8] = { 20, 45, 90, 175, 330, 600, 1000, 1000 };
+    int Rate = Rates[(shadow_[1] >> 5) & 0x07];
+
+    switch (shadow_[1] & 0x18)
+    {
+        case ADS1220_MODE_TURBO:
+            return Rate * 2;
+        case ADS1220_MODE_DUTY:
+            return Rate / 4;
+        default:
+            return Rate;
+    }
+}
+
 int ADS1220::GetChannel(void)
 {
     unsigned Temp;
@@ -1122,6 +1279,490 @@ void ADS1220::set_DRDYM(char c)
 
 
 
+/*
+******************************************************************************
+ burst acquisition
+*/
+
+int ADS1220::AcquireBurst(int32_t *Data, uint16_t Count, int Timeout)
+{
+    int Status = ADS1220_NO_ERROR;
+    bool SingleShot = !(shadow_[1] & ADS1220_CC);
+    uint32_t Start;
+
+    if (streaming_ || Data == NULL)
+        return ADS1220_ERROR;
+
+    Start = us_ticker_read();
+    SendStartCommand();  // also wakes from power-down
+    for (uint16_t i = 0; i < Count; i++)
+    {
+        if (SingleShot && i > 0)
+            SendStartCommand();
+
+        Status = WaitForDataReady(Timeout);
+        if (Status != ADS1220_NO_ERROR)
+            break;
+        Data[i] = (int32_t)ReadData();
+    }
+    SendShutdownCommand();
+    burstUs_ = us_ticker_read() - Start;
+
+    return Status;
+}
+
+uint32_t ADS1220::GetBurstTimeUs(void)
+{
+    return burstUs_;
+}
+
+/*
+******************************************************************************
+ streaming acquisition
+*/
+
+int ADS1220::StartStream(EventQueue *queue, Callback<void(const ADS1220Block *)> block_done)
+{
+    if (queue == NULL || streaming_)
+        return ADS1220_ERROR;
+
+    queue_ = queue;
+    block_done_ = block_done;
+    blocks_[0].Count = 0;
+    blocks_[1].Count = 0;
+    active_ = 0;
+    pending_ = false;
+    busy_ = false;
+    overruns_ = 0;
+    scanPos_ = 0;  // SetScan() left entry 0 in register 0
+    scanVisit_ = 0;
+    auxActive_ = 0;
+    suspect_ = false;
+
+    // Direct read: 3 bytes, no RDATA
+    tx_[0] = directRead_ ? 0 : ADS1220_CMD_RDATA;
+    tx_[1] = tx_[2] = tx_[3] = 0;
+
+    streaming_ = true;
+    if (drdyOnDout_)
+        RearmDout();  // a conversion may already be waiting
+    else
+        drdy_.fall(callback(this, &ADS1220::OnDataReady));
+    return ADS1220_NO_ERROR;
+}
+
+void ADS1220::StopStream(void)
+{
+    streaming_ = false;
+    if (drdyOnDout_)
+        gpio_irq_disable(&doutIrq_);
+    else
+        drdy_.fall(NULL);
+}
+
+uint32_t ADS1220::GetStreamOverruns(void)
+{
+    return overruns_;
+}
+
+void ADS1220::OnDataReady(void)
+{
+    // SPI::transfer() takes the bus mutex, so it cannot be started from here
+    if (!streaming_)
+        return;
+
+    // An edge latched from the data bits of the last frame, not a new conversion
+    if (drdyOnDout_ && !DoutLow())
+        return;
+
+    if (busy_) {
+        overruns_++;
+        return;
+    }
+
+    busy_ = true;
+    stamp_ = us_ticker_read();
+    if (drdyOnDout_)
+        gpio_irq_disable(&doutIrq_);  // the data bits toggle DOUT/DRDY
+    if (queue_->call(this, &ADS1220::StartTransfer) == 0) {
+        busy_ = false;  // queue full
+        overruns_++;
+    }
+}
+
+void ADS1220::StartTransfer(void)
+{
+    uint8_t Length = PrepareFrame();
+
+#if DEVICE_SPI_ASYNCH
+    AssertCS(true);
+    busBytes_ += Length;
+    if (_device.transfer(tx_, Length, rx_, Length, callback(this, &ADS1220::OnTransferDone), SPI_EVENT_COMPLETE) != 0) {
+        AssertCS(false);
+        DropFrame();
+    }
+#else
+    // No asynchronous SPI on this target: read here, still off the interrupt
+    AssertCS(true);
+    busBytes_ += Length;
+    _device.write(tx_, Length, rx_, Length);
+    AssertCS(false);
+    StoreConversion();
+#endif
+}
+
+void ADS1220::OnTransferDone(int event)
+{
+    AssertCS(false);
+    if (event & SPI_EVENT_COMPLETE) {
+        StoreConversion();
+    } else {
+        DropFrame();
+    }
+}
+
+void ADS1220::DropFrame(void)
+{
+    // The staged scan and auxiliary state is thrown away, the next frame sends it again
+    core_util_critical_section_enter();
+    auxRequest_ |= next_.AuxTaken;
+    core_util_critical_section_exit();
+    if (next_.Switch)
+        suspect_ = true;  // part of the WREG may have reached the device
+
+    busy_ = false;
+    overruns_++;
+    RearmDout();
+}
+
+void ADS1220::StoreConversion(void)
+{
+    uint32_t Data;
+    ADS1220Block *block = &blocks_[active_];
+
+    // With RDATA, rx_[0] was clocked in while the command went out
+    const char *rx = directRead_ ? &rx_[0] : &rx_[1];
+    Data = ((uint32_t)(uint8_t)rx[0] << 16) | ((uint32_t)(uint8_t)rx[1] << 8) | (uint8_t)rx[2];
+    if (Data & 0x800000)
+        Data |= 0xff000000;
+
+    block->Data[block->Count] = (int32_t)Data;
+    block->Timestamp[block->Count] = stamp_;
+    block->Tag[block->Count] = tag_;
+    block->Count++;
+
+    // The frame went through: the device now runs what it carried
+    scanPos_ = next_.ScanPos;
+    scanVisit_ = next_.ScanVisit;
+    auxActive_ = next_.AuxActive;
+    shadow_[0] = next_.Shadow[0];
+    shadow_[1] = next_.Shadow[1];
+    shadow_[2] = next_.Shadow[2];
+    busy_ = false;
+    RearmDout();
+
+    if (block->Count < ADS1220_BLOCK_SIZE)
+        return;
+
+    if (pending_) {
+        // The callback still owns the other half; drop this block rather than tear that one
+        overruns_ += block->Count;
+        block->Count = 0;
+        return;
+    }
+
+    pending_ = true;
+    uint8_t full = active_;
+    active_ ^= 1;
+    blocks_[active_].Count = 0;
+    if (queue_->call(this, &ADS1220::DeliverBlock, full) == 0)
+        pending_ = false;
+}
+
+uint8_t ADS1220::StreamLength(void)
+{
+    return directRead_ ? 3 : 4;
+}
+
+uint8_t ADS1220::PrepareFrame(void)
+{
+    uint8_t Length = StreamLength();
+    const ADS1220ScanEntry *Entry;
+
+    // Staged here, taken over by StoreConversion() only once the frame went through
+    next_.ScanPos = scanPos_;
+    next_.ScanVisit = scanVisit_;
+    next_.AuxActive = auxActive_;
+    next_.AuxTaken = 0;
+    next_.Switch = false;
+    next_.Shadow[0] = shadow_[0];
+    next_.Shadow[1] = shadow_[1];
+    next_.Shadow[2] = shadow_[2];
+
+    // After a failed switch the conversion may come from either input
+    uint8_t Suspect = suspect_ ? ADS1220_TAG_UNSETTLED : 0;
+    suspect_ = false;
+
+    if (auxActive_)
+    {
+        // The auxiliary conversion is read now; the scan stays where it was
+        tag_ = auxActive_ | Suspect;
+        return AuxFrame(Length, scanPos_ == 0);
+    }
+
+    tag_ = Suspect;
+    if (scanCount_ == 0)
+        return AuxFrame(Length, true);
+
+    Entry = &scan_[scanPos_];
+    tag_ |= scanPos_;
+    if (scanVisit_ < Entry->Discard)
+        tag_ |= ADS1220_TAG_UNSETTLED;
+    if (scanVisit_ < Entry->Discard + Entry->Samples)
+        next_.ScanVisit++;
+
+    if (scanCount_ == 1 || next_.ScanVisit < Entry->Discard + Entry->Samples)
+        return AuxFrame(Length, scanPos_ == 0);
+
+    // Last conversion of the visit: the next input goes out in the same frame
+    next_.ScanPos = (scanPos_ + 1) % scanCount_;
+    next_.ScanVisit = 0;
+    next_.Switch = true;
+    Entry = &scan_[next_.ScanPos];
+    next_.Shadow[0] = Entry->Mux | Entry->Gain | Entry->Bypass;
+    tx_[Length + 1] = next_.Shadow[0];
+    if ((shadow_[2] & ADS1220_VREF_MASK) == Entry->Vref)
+    {
+        tx_[Length] = ADS1220_CMD_WREG | (ADS1220_0_REGISTER << 2);
+        return Length + 2;
+    }
+
+    next_.Shadow[2] = (shadow_[2] & ~ADS1220_VREF_MASK) | Entry->Vref;
+    tx_[Length] = ADS1220_CMD_WREG | (ADS1220_0_REGISTER << 2) | 0x02;
+    tx_[Length + 2] = next_.Shadow[1];
+    tx_[Length + 3] = next_.Shadow[2];
+    return Length + 4;
+}
+
+uint8_t ADS1220::AuxFrame(uint8_t Length, bool AllowOffset)
+{
+    static const uint8_t Order[3] = { ADS1220_TAG_OFFSET, ADS1220_TAG_TEMPERATURE, ADS1220_TAG_AVDD };
+    unsigned From[3], To[3];
+    uint8_t Next = 0;
+    int First = -1, Last = -1;
+
+    core_util_critical_section_enter();
+    for (int i = 0; i < 3; i++)
+    {
+        if ((auxRequest_ & Order[i]) && (AllowOffset || Order[i] != ADS1220_TAG_OFFSET))
+        {
+            Next = Order[i];
+            auxRequest_ &= ~Next;
+            break;
+        }
+    }
+    core_util_critical_section_exit();
+    next_.AuxTaken = Next;  // requested again if the frame fails
+
+    if (Next == auxActive_)
+        return Length;
+
+    // One WREG over the registers that change, from what the device runs now
+    AuxRegisters(auxActive_, From);
+    AuxRegisters(Next, To);
+    next_.AuxActive = Next;
+    for (int r = 0; r < 3; r++)
+    {
+        if (From[r] != To[r])
+        {
+            if (First < 0)
+                First = r;
+            Last = r;
+        }
+    }
+    if (First < 0)
+        return Length;
+
+    next_.Switch = true;
+    tx_[Length++] = ADS1220_CMD_WREG | (First << 2) | (Last - First);
+    for (int r = First; r <= Last; r++)
+        tx_[Length++] = To[r];
+    return Length;
+}
+
+void ADS1220::AuxRegisters(uint8_t Aux, unsigned *Regs)
+{
+    Regs[0] = shadow_[0];
+    Regs[1] = shadow_[1];
+    Regs[2] = shadow_[2];
+
+    switch (Aux)
+    {
+        case ADS1220_TAG_OFFSET:
+            Regs[0] = (shadow_[0] & 0x0f) | ADS1220_MUX_DIV2;  // same gain and bypass
+            break;
+        case ADS1220_TAG_TEMPERATURE:
+            Regs[1] = shadow_[1] | ADS1220_TEMP_SENSOR;
+            break;
+        case ADS1220_TAG_AVDD:
+            Regs[0] = ADS1220_MUX_AVDD | ADS1220_GAIN_1 | ADS1220_PGA_BYPASS;
+            Regs[2] = (shadow_[2] & ~ADS1220_VREF_MASK) | ADS1220_VREF_INT;
+            break;
+        default:
+            break;
+    }
+}
+
+void ADS1220::RequestAuxSample(uint8_t Tags)
+{
+    core_util_critical_section_enter();
+    auxRequest_ |= Tags & ADS1220_TAG_AUX;
+    core_util_critical_section_exit();
+}
+
+void ADS1220::RequestOffsetSample(void)
+{
+    RequestAuxSample(ADS1220_TAG_OFFSET);
+}
+
+int ADS1220::SetScan(const ADS1220ScanEntry *Entries, uint8_t Count)
+{
+    unsigned reg;
+
+    if (streaming_ || Count > ADS1220_SCAN_MAX)
+        return ADS1220_ERROR;
+
+    for (uint8_t i = 0; i < Count; i++)
+    {
+        if (Entries[i].Samples == 0)
+            return ADS1220_ERROR;
+        scan_[i] = Entries[i];
+    }
+
+    scanCount_ = Count;
+    scanPos_ = 0;
+    scanVisit_ = 0;
+    if (Count > 0)
+    {
+        reg = scan_[0].Mux | scan_[0].Gain | scan_[0].Bypass;
+        WriteRegister(ADS1220_0_REGISTER, 0x01, &reg);
+        reg = (shadow_[2] & ~ADS1220_VREF_MASK) | scan_[0].Vref;
+        WriteRegister(ADS1220_2_REGISTER, 0x01, &reg);
+    }
+    return ADS1220_NO_ERROR;
+}
+
+void ADS1220::RearmDout(void)
+{
+    if (!drdyOnDout_ || !streaming_)
+        return;
+
+    gpio_irq_enable(&doutIrq_);
+
+    // A falling edge while the EXTI was off is lost; DOUT already low is a conversion waiting
+    core_util_critical_section_enter();
+    if (!busy_ && DoutLow()) {
+        __HAL_GPIO_EXTI_CLEAR_IT(doutMask_);  // served here, not again by the interrupt
+        OnDataReady();
+    }
+    core_util_critical_section_exit();
+}
+
+bool ADS1220::DoutLow(void)
+{
+    return (doutPort_->IDR & doutMask_) == 0;
+}
+
+void ADS1220::DoutIrq(uint32_t id, gpio_irq_event event)
+{
+    if (event == IRQ_FALL)
+        ((ADS1220 *)id)->OnDataReady();
+}
+
+/*
+******************************************************************************
+ direct read, DRDY on DOUT and bus counters
+*/
+
+void ADS1220::SetDirectRead(bool Enable)
+{
+    directRead_ = Enable;
+}
+
+int ADS1220::SetDRDYOnDout(bool Enable)
+{
+    unsigned reg;
+
+    if (streaming_)
+        return ADS1220_ERROR;
+
+    if (Enable && !drdyOnDout_)
+    {
+        // EXTI on the MISO line; unlike InterruptIn this leaves the pin in its SPI function
+        if (gpio_irq_init(&doutIrq_, miso_, &ADS1220::DoutIrq, (uint32_t)this) != 0)
+            return ADS1220_ERROR;
+        gpio_irq_set(&doutIrq_, IRQ_FALL, 1);
+        gpio_irq_disable(&doutIrq_);  // armed by StartStream()
+
+        // gpio_irq_init() has enabled the port clock
+        switch (STM_PORT(miso_)) {
+            case 0: doutPort_ = GPIOA; break;
+            case 1: doutPort_ = GPIOB; break;
+            case 2: doutPort_ = GPIOC; break;
+#ifdef GPIOD
+            case 3: doutPort_ = GPIOD; break;
+#endif
+#ifdef GPIOE
+            case 4: doutPort_ = GPIOE; break;
+#endif
+#ifdef GPIOF
+            case 5: doutPort_ = GPIOF; break;
+#endif
+#ifdef GPIOG
+            case 6: doutPort_ = GPIOG; break;
+#endif
+            default: doutPort_ = GPIOH; break;
+        }
+        doutMask_ = 1UL << STM_PIN(miso_);
+    }
+    else if (!Enable && drdyOnDout_)
+    {
+        gpio_irq_free(&doutIrq_);
+    }
+
+    // Before the write, WriteRegister() keeps DRDYM set as long as drdyOnDout_ is
+    drdyOnDout_ = Enable;
+    csHeld_ = Enable;
+    ReadRegister(ADS1220_3_REGISTER, 0x01, &reg);
+    reg = Enable ? (reg | ADS1220_DRDY_MODE) : (reg & ~ADS1220_DRDY_MODE);
+    WriteRegister(ADS1220_3_REGISTER, 0x01, &reg);
+    nCS_ = Enable ? 0 : 1;
+    return ADS1220_NO_ERROR;
+}
+
+uint32_t ADS1220::GetTransactionCount(void)
+{
+    return transactions_;
+}
+
+uint32_t ADS1220::GetBusTimeUs(void)
+{
+    return (uint32_t)((uint64_t)busBytes_ * 8 * 1000000 / frequency_);
+}
+
+void ADS1220::ResetBusCounters(void)
+{
+    transactions_ = 0;
+    busBytes_ = 0;
+}
+
+void ADS1220::DeliverBlock(uint8_t index)
+{
+    if (block_done_)
+        block_done_(&blocks_[index]);
+    pending_ = false;
+}
+
 void ADS1220::set_ERROR_Transmit(void)
 {
     /* De-initialize the SPI comunication BUS */
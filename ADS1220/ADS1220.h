@@ -11,6 +11,7 @@
 #ifndef ADS1220_H_
 #define ADS1220_H_
 #include "mbed.h"
+#include "hal/gpio_irq_api.h"
 
 #define COUNTOF(__BUFFER__)   (sizeof(__BUFFER__) / sizeof(*(__BUFFER__)))
 #define gain_error_correction 0.9107468123861566//0.9980039920159681//6218905 // 0.977517107
@@ -109,6 +110,7 @@
 #define ADS1220_VREF_EX_DED 0x40
 #define ADS1220_VREF_EX_AIN 0x80
 #define ADS1220_VREF_SUPPLY 0xc0
+#define ADS1220_VREF_MASK   0xc0
 
 // Define 50/60 (filter response)
 #define ADS1220_REJECT_OFF  0x00
@@ -156,6 +158,44 @@
 
 #define ADS1220_DRDY_MODE   0x02
 
+/* Burst acquisition */
+#define ADS1220_FLAG_DRDY   0x01
+
+/* Streaming acquisition */
+#ifndef ADS1220_BLOCK_SIZE
+#define ADS1220_BLOCK_SIZE  20          // conversions per block, 1 s at 20 SPS
+#endif
+
+#define ADS1220_SCAN_MAX        4       // entries of the MUX scan sequence
+
+// Block Tag: scan entry the conversion belongs to, plus a flag for the settling conversions
+#define ADS1220_TAG_ENTRY       0x0f
+#define ADS1220_TAG_AVDD        0x10    // (AVDD - AVSS) / 4 against the internal reference, see RequestAuxSample()
+#define ADS1220_TAG_TEMPERATURE 0x20    // internal temperature sensor
+#define ADS1220_TAG_OFFSET      0x40    // shorted-input conversion
+#define ADS1220_TAG_AUX         0x70    // any of the three: not a conversion of the input
+#define ADS1220_TAG_UNSETTLED   0x80
+
+// One half of the double buffer; handed to the block callback once full
+typedef struct
+{
+    int32_t  Data[ADS1220_BLOCK_SIZE];       // sign-extended conversion results
+    uint32_t Timestamp[ADS1220_BLOCK_SIZE];  // us_ticker at the DRDY falling edge
+    uint8_t  Tag[ADS1220_BLOCK_SIZE];        // ADS1220_TAG_*, 0 without a scan
+    uint16_t Count;
+} ADS1220Block;
+
+// One input of the MUX scan sequence
+typedef struct
+{
+    uint8_t Mux;                             // ADS1220_MUX_*
+    uint8_t Gain;                            // ADS1220_GAIN_*
+    uint8_t Bypass;                          // ADS1220_PGA_BYPASS or 0
+    uint8_t Vref;                            // ADS1220_VREF_*, e.g. internal for a supply monitor
+    uint8_t Samples;                         // conversions kept per visit, at least 1
+    uint8_t Discard;                         // conversions tagged ADS1220_TAG_UNSETTLED before them
+} ADS1220ScanEntry;
+
 class ADS1220 {
 public:
 
@@ -165,27 +205,96 @@ public:
      * @param scl is the pin for I2C SCL
      * @param address is the 7-bit address (default is 0x27 for the device)
      */
-    ADS1220(PinName mosi, PinName miso, PinName sclk, PinName cs);
+    ADS1220(PinName mosi, PinName miso, PinName sclk, PinName cs, PinName drdy = NC);
 
 
         /* Low Level ADS1220 Device Functions */
         void Init(void);                         // Device intialization
-        int WaitForDataReady(int Timeout);       // DRDY polling 
+        int WaitForDataReady(int Timeout);       // DRDY falling edge, Timeout in ms
         void AssertCS(bool fAssert);              // Assert/deassert CS
         void SendByte(unsigned char cData );     // Send byte to the ADS1220
         unsigned int ReceiveByte(void);          // Receive byte from the ADS1220
 
         /* ADS1220 Higher Level Functions */
         unsigned int ReadData(void);                     // Read the data results    
-        void ReadRegister(int StartAddress, int NumRegs, unsigned * pData);  // Read the register(s)
+        void ReadRegister(int StartAddress, int NumRegs, unsigned * pData);  // Read the register(s), from the shadow
         void WriteRegister(int StartAddress, int NumRegs, unsigned * pData); // Write the register(s)
+        void BeginUpdate(void);                  // Stage WriteRegister()/Set*() in the shadow only
+        int Commit(bool DoVerify = false);       // Send the shadow as one 4-register WREG, optionally read it back
+        int Verify(void);                        // Read the 4 registers from the device and compare with the shadow
+        int Apply(uint8_t Reg0, uint8_t Reg1, uint8_t Reg2, uint8_t Reg3, bool DoVerify = false);  // All 4 registers in one WREG, see ADS1220Config.h
         void SendResetCommand(void);             // Send a device Reset Command
         void SendStartCommand(void);             // Send a Start/SYNC command
         void SendShutdownCommand(void);          // Place the device in powerdown mode
+
+        /* Streaming acquisition
+        *
+        *   Every DRDY falling edge is deferred to the queue's thread, which starts a
+        *   non-blocking SPI::transfer() of the conversion (DMA or interrupt driven,
+        *   DEVICE_SPI_ASYNCH); the completion interrupt stores it into one half of a
+        *   double buffer. Full blocks are handed to the callback on the queue's thread
+        *   while the other half keeps filling. Needs the drdy pin and continuous mode.
+        */
+        int StartStream(EventQueue *queue, Callback<void(const ADS1220Block *)> block_done);
+        void StopStream(void);
+        uint32_t GetStreamOverruns(void);        // conversions lost: DRDY while busy or no free block
+
+        /* Burst acquisition
+        *
+        *   Wakes the device, takes Count conversions and sends it back to power-down:
+        *   one START per conversion in single-shot mode, one for all in continuous or
+        *   duty-cycle mode. The low-side switch (PSW) opens with the power-down, so the
+        *   bridge draws no current in between. Not while streaming.
+        */
+        int AcquireBurst(int32_t *Data, uint16_t Count, int Timeout);
+        uint32_t GetBurstTimeUs(void);           // START to power-down of the last burst
+
+        /* MUX scan sequence
+        *
+        *   While streaming, the register 0 write (MUX, gain, PGA bypass) of the next entry
+        *   is appended to the read of the last conversion of a visit, in the same CS frame
+        *   right after DRDY; registers 0-2 when the reference changes too. The write
+        *   restarts the conversion on the new input. Every
+        *   conversion is tagged with its entry in ADS1220Block::Tag. Set it before
+        *   StartStream(); Count 0 goes back to the single input of register 0.
+        *   The scan only moves on once the frame went through; a failed one is sent again
+        *   at the next DRDY and the conversion read then is tagged ADS1220_TAG_UNSETTLED.
+        */
+        int SetScan(const ADS1220ScanEntry *Entries, uint8_t Count);
+
+        /* Auxiliary conversions
+        *
+        *   Each requested ADS1220_TAG_AVDD / _TEMPERATURE / _OFFSET conversion takes one
+        *   slot of the input stream: the registers that differ are written in the read
+        *   frame after DRDY, the conversion comes back with that tag, and the next frame
+        *   goes on to the next request or back to the input. Only the slots used are lost.
+        *   The shorted-input offset is taken at the gain of scan entry 0 and only in its
+        *   slots; the others wait for a frame without a scan switch. The shadow keeps the
+        *   input setting meanwhile.
+        */
+        void RequestAuxSample(uint8_t Tags);
+        void RequestOffsetSample(void);          // RequestAuxSample(ADS1220_TAG_OFFSET)
+
+        /* Direct read and DRDY on DOUT
+        *
+        *   In continuous-conversion mode the result can be clocked out right after DRDY
+        *   without RDATA: 24 SCLKs per sample. With DRDYM set the DOUT/DRDY line also
+        *   signals data ready, so the DRDY pin is not needed; CS is then held low.
+        *   While it is enabled every register write keeps DRDYM set, Config() and Apply()
+        *   included. The EXTI is off while a frame is read; a conversion that became ready
+        *   meanwhile is picked up from the DOUT level when it is re-armed (STM32 only).
+        */
+        void SetDirectRead(bool Enable);
+        int SetDRDYOnDout(bool Enable);          // sets DRDYM and watches the falling edge on MISO
+        uint32_t GetTransactionCount(void);      // CS-framed transfers since ResetBusCounters()
+        uint32_t GetBusTimeUs(void);             // SCLK time of the bytes clocked since ResetBusCounters()
+        void ResetBusCounters(void);
                 
 
         /* Register Set Value Commands */
         void Config(void);
+        void Config(int DataRate, int Mode);     // e.g. ADS1220_DR_1000, ADS1220_MODE_TURBO: 2 kSPS
+        int GetSampleRate(void);                 // conversions per second of the DR/MODE in the shadow
         int SetChannel(int Mux);
         int SetGain(int Gain);
         int SetPGABypass(int Bypass);
@@ -251,6 +360,65 @@ public:
 private:
     SPI                 _device;
     DigitalOut          nCS_;
+    InterruptIn         drdy_;
+    bool                hasDrdy_;
+    EventFlags          drdyFlags_;
+    uint32_t            burstUs_;
+    EventQueue          *queue_;
+    Callback<void(const ADS1220Block *)> block_done_;
+    ADS1220Block        blocks_[2];
+    volatile uint8_t    active_;            // block being filled
+    volatile bool       pending_;           // the other block is with the callback
+    volatile bool       busy_;              // a conversion is being read
+    volatile bool       streaming_;
+    volatile uint32_t   stamp_;
+    volatile uint32_t   overruns_;
+    char                tx_[8];             // RDATA/NOP + 3 data bytes, optional WREG of registers 0(-2)
+    char                rx_[8];
+    ADS1220ScanEntry    scan_[ADS1220_SCAN_MAX];
+    uint8_t             scanCount_;
+    uint8_t             scanPos_;           // entry being converted
+    uint8_t             scanVisit_;         // conversions of the current visit read so far
+    uint8_t             tag_;               // tag of the conversion being read
+    volatile uint8_t    auxRequest_;        // ADS1220_TAG_AVDD/_TEMPERATURE/_OFFSET still to take
+    uint8_t             auxActive_;         // the auxiliary conversion the device runs, 0: the input
+    struct {
+        uint8_t         ScanPos;
+        uint8_t         ScanVisit;
+        uint8_t         AuxActive;
+        uint8_t         AuxTaken;           // request consumed by the frame
+        bool            Switch;             // the frame carries a WREG
+        unsigned        Shadow[3];
+    }                   next_;              // state the frame in flight leaves behind, see StoreConversion()
+    bool                suspect_;           // a switch failed: tag the next conversion ADS1220_TAG_UNSETTLED
+    unsigned            shadow_[4];         // configuration registers as last written
+    bool                deferWrites_;
+    PinName             miso_;
+    gpio_irq_t          doutIrq_;
+    GPIO_TypeDef *      doutPort_;          // MISO level read from IDR, the pin keeps its SPI function
+    uint32_t            doutMask_;
+    bool                directRead_;
+    bool                csHeld_;
+    bool                drdyOnDout_;
+    volatile uint32_t   transactions_;
+    volatile uint32_t   busBytes_;
+    int                 frequency_;
+
+    void ReadDeviceRegisters(unsigned * pData);
+    void OnDataReady(void);
+    void OnDrdyEdge(void);
+    void StartTransfer(void);
+    void OnTransferDone(int event);
+    void StoreConversion(void);
+    void DropFrame(void);
+    void DeliverBlock(uint8_t index);
+    uint8_t StreamLength(void);
+    uint8_t PrepareFrame(void);
+    uint8_t AuxFrame(uint8_t Length, bool AllowOffset);
+    void AuxRegisters(uint8_t Aux, unsigned *Regs);
+    void RearmDout(void);
+    bool DoutLow(void);
+    static void DoutIrq(uint32_t id, gpio_irq_event event);
     uint8_t _address;
     uint8_t _Comdelay;
 
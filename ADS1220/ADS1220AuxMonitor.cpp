@@ -0,0 +1,115 @@
+#include "mbed.h"
+#include "ADS1220AuxMonitor.h"
+
+#define Q30 (1L << 30)
+#define GAIN_MIN 0.5f   // a bad AVDD reading or coefficient must not overflow gainQ30_
+#define GAIN_MAX 1.5f
+
+ADS1220AuxMonitor::ADS1220AuxMonitor(ADS1220 &Device, uint32_t IntervalMs) :
+    device_(Device),
+    intervalUs_(IntervalMs * 1000),
+    lastRequest_(0),
+    requested_(false),
+    tempco_(0),
+    tempRef_(25),
+    excitation_(false),
+    avddRef_(0),
+    temperature_(0),
+    avdd_(0),
+    seen_(0),
+    gainQ30_(Q30)
+{
+}
+
+void ADS1220AuxMonitor::SetTemperatureCoefficient(float PpmPerC, float TempRefC)
+{
+    tempco_ = PpmPerC * 1e-6f;
+    tempRef_ = TempRefC;
+    Update();
+}
+
+void ADS1220AuxMonitor::SetExcitationCorrection(bool Enable, float AvddRefV)
+{
+    excitation_ = Enable;
+    avddRef_ = AvddRefV;
+    Update();
+}
+
+void ADS1220AuxMonitor::Process(const ADS1220Block *Block)
+{
+    bool Changed = false;
+
+    for (uint16_t i = 0; i < Block->Count; i++)
+    {
+        if (Block->Tag[i] & ADS1220_TAG_UNSETTLED)
+            continue;
+        if (Block->Tag[i] & ADS1220_TAG_TEMPERATURE)
+        {
+            temperature_ = (Block->Data[i] >> 10) * ADS1220_TEMP_LSB_C;
+            seen_ |= ADS1220_TAG_TEMPERATURE;
+            Changed = true;
+        }
+        else if (Block->Tag[i] & ADS1220_TAG_AVDD)
+        {
+            avdd_ = Block->Data[i] * (4 * ADS1220_VREF_INT_V / (1L << 23));
+            seen_ |= ADS1220_TAG_AVDD;
+            Changed = true;
+        }
+    }
+    if (Changed)
+        Update();
+
+    // Paced by the conversion timestamps, no timer of its own
+    if (Block->Count == 0)
+        return;
+    uint32_t Now = Block->Timestamp[Block->Count - 1];
+    if (!requested_ || (uint32_t)(Now - lastRequest_) >= intervalUs_)
+    {
+        device_.RequestAuxSample(Wanted());
+        lastRequest_ = Now;
+        requested_ = true;
+    }
+}
+
+void ADS1220AuxMonitor::Update(void)
+{
+    float Gain = 1;
+
+    // Once per reading, not per conversion
+    if ((seen_ & ADS1220_TAG_TEMPERATURE) && tempco_ != 0)
+        Gain /= 1 + tempco_ * (temperature_ - tempRef_);
+    if ((seen_ & ADS1220_TAG_AVDD) && excitation_ && avdd_ > 0)
+        Gain *= avddRef_ / avdd_;
+
+    if (!(Gain >= GAIN_MIN))  // NaN too
+        Gain = GAIN_MIN;
+    else if (Gain > GAIN_MAX)
+        Gain = GAIN_MAX;
+    gainQ30_ = (int32_t)(Gain * Q30);
+}
+
+int32_t ADS1220AuxMonitor::Correct(int32_t Raw, int32_t Zero)
+{
+    return Zero + (int32_t)(((int64_t)(Raw - Zero) * gainQ30_) >> 30);
+}
+
+float ADS1220AuxMonitor::GetTemperature(void)
+{
+    return temperature_;
+}
+
+float ADS1220AuxMonitor::GetAvdd(void)
+{
+    return avdd_;
+}
+
+bool ADS1220AuxMonitor::IsValid(void)
+{
+    return (seen_ & Wanted()) == Wanted();
+}
+
+// AVDD only takes a slot when the excitation correction uses it
+uint8_t ADS1220AuxMonitor::Wanted(void)
+{
+    return ADS1220_TAG_TEMPERATURE | (excitation_ ? ADS1220_TAG_AVDD : 0);
+}
@@ -0,0 +1,60 @@
+#ifndef ADS1220_AUX_MONITOR_H_
+#define ADS1220_AUX_MONITOR_H_
+
+#include "mbed.h"
+#include "ADS1220.h"
+
+#define ADS1220_TEMP_LSB_C      0.03125f    // 14 bit result, left-justified in the 24 bit data
+#define ADS1220_VREF_INT_V      2.048f
+
+/**
+ * Low-duty temperature and AVDD monitoring of a streaming ADS1220.
+ *
+ * Every Interval one internal temperature conversion, and one (AVDD - AVSS) / 4
+ * conversion while the excitation correction is on, are requested
+ * (ADS1220::RequestAuxSample(), one slot of the input stream each). The readings
+ * are cached and folded into one Q30 gain factor, limited to 0.5 .. 1.5, so
+ * Correct() is a single multiply per conversion:
+ *
+ *     gain = 1 / (1 + TempCo * (T - TempRef))           span temperature coefficient
+ *          * AvddRef / AVDD                             when the bridge is not ratiometric
+ *
+ * Until the first readings the factor is 1. Call Process() from the stream's
+ * block callback.
+ */
+class ADS1220AuxMonitor
+{
+public:
+    ADS1220AuxMonitor(ADS1220 &Device, uint32_t IntervalMs);
+
+    /** Span temperature coefficient in ppm/degC around TempRefC; 0 disables */
+    void SetTemperatureCoefficient(float PpmPerC, float TempRefC);
+
+    /** Scale by AvddRefV / AVDD; only for a bridge not referenced to its own excitation */
+    void SetExcitationCorrection(bool Enable, float AvddRefV);
+
+    void Process(const ADS1220Block *Block);
+    int32_t Correct(int32_t Raw, int32_t Zero);  // Zero + (Raw - Zero) * gain
+    float GetTemperature(void);                 // degC, last reading
+    float GetAvdd(void);                        // V, last reading
+    bool IsValid(void);                         // all requested inputs read at least once
+
+private:
+    void Update(void);
+    uint8_t Wanted(void);                       // ADS1220_TAG_* requested every interval
+
+    ADS1220 &device_;
+    uint32_t intervalUs_;
+    uint32_t lastRequest_;
+    bool requested_;
+    float tempco_;                              // 1/degC
+    float tempRef_;
+    bool excitation_;
+    float avddRef_;
+    float temperature_;
+    float avdd_;
+    uint8_t seen_;                              // ADS1220_TAG_TEMPERATURE | ADS1220_TAG_AVDD read so far
+    int32_t gainQ30_;
+};
+
+#endif /*ADS1220_AUX_MONITOR_H_*/
@@ -0,0 +1,186 @@
+#ifndef ADS1220_CONFIG_H_
+#define ADS1220_CONFIG_H_
+
+#include "ADS1220.h"
+
+/* Typed ADS1220 configuration
+*
+*   The four register bytes are computed by the compiler from the template arguments and the
+*   invalid combinations fail the build (static_assert) instead of reaching set_ERROR() at run
+*   time. Start from the defaults and replace what differs:
+*
+*       typedef ADS1220Config<>
+*           ::WithMux<ADS1220Mux::AIN1_AIN2>
+*           ::WithGain<ADS1220Gain::x128>
+*           ::WithVref<ADS1220Vref::REFP1_REFN1>
+*           ::WithRejection<ADS1220Rejection::Both> Bridge;
+*
+*       Bridge::Apply(adc);                      // one 4-register WREG
+*
+*   The defaults are the power-on values, except for continuous conversion mode. Every step
+*   is a complete configuration and is checked, so clear a dependent setting before changing
+*   what it depends on (e.g. WithRejection<Off> before WithRate<SPS1000, Turbo>).
+*/
+
+enum class ADS1220Mux : uint8_t
+{
+    AIN0_AIN1 = ADS1220_MUX_0_1,
+    AIN0_AIN2 = ADS1220_MUX_0_2,
+    AIN0_AIN3 = ADS1220_MUX_0_3,
+    AIN1_AIN2 = ADS1220_MUX_1_2,
+    AIN1_AIN3 = ADS1220_MUX_1_3,
+    AIN2_AIN3 = ADS1220_MUX_2_3,
+    AIN1_AIN0 = ADS1220_MUX_1_0,
+    AIN3_AIN2 = ADS1220_MUX_3_2,
+    AIN0_AVSS = ADS1220_MUX_0_G,
+    AIN1_AVSS = ADS1220_MUX_1_G,
+    AIN2_AVSS = ADS1220_MUX_2_G,
+    AIN3_AVSS = ADS1220_MUX_3_G,
+    REF_DIV4  = ADS1220_MUX_EX_VREF,         // (V(REFPx) - V(REFNx)) / 4, PGA bypassed
+    AVDD_DIV4 = ADS1220_MUX_AVDD,            // (AVDD - AVSS) / 4, PGA bypassed
+    SHORTED   = ADS1220_MUX_DIV2             // AINP and AINN shorted to (AVDD + AVSS) / 2
+};
+
+enum class ADS1220Gain : uint8_t
+{
+    x1   = ADS1220_GAIN_1,
+    x2   = ADS1220_GAIN_2,
+    x4   = ADS1220_GAIN_4,
+    x8   = ADS1220_GAIN_8,
+    x16  = ADS1220_GAIN_16,
+    x32  = ADS1220_GAIN_32,
+    x64  = ADS1220_GAIN_64,
+    x128 = ADS1220_GAIN_128
+};
+
+// Normal-mode rates; twice as fast in turbo mode, a quarter in duty-cycle mode
+enum class ADS1220Rate : uint8_t
+{
+    SPS20   = ADS1220_DR_20,
+    SPS45   = ADS1220_DR_45,
+    SPS90   = ADS1220_DR_90,
+    SPS175  = ADS1220_DR_175,
+    SPS330  = ADS1220_DR_330,
+    SPS600  = ADS1220_DR_600,
+    SPS1000 = ADS1220_DR_1000
+};
+
+enum class ADS1220Mode : uint8_t
+{
+    Normal    = ADS1220_MODE_NORMAL,
+    DutyCycle = ADS1220_MODE_DUTY,
+    Turbo     = ADS1220_MODE_TURBO
+};
+
+enum class ADS1220Vref : uint8_t
+{
+    Internal    = ADS1220_VREF_INT,          // 2.048 V
+    REFP0_REFN0 = ADS1220_VREF_EX_DED,
+    REFP1_REFN1 = ADS1220_VREF_EX_AIN,       // shared with AIN0 / AIN3
+    Supply      = ADS1220_VREF_SUPPLY
+};
+
+enum class ADS1220Rejection : uint8_t
+{
+    Off  = ADS1220_REJECT_OFF,
+    Both = ADS1220_REJECT_BOTH,
+    Hz50 = ADS1220_REJECT_50,
+    Hz60 = ADS1220_REJECT_60
+};
+
+enum class ADS1220Idac : uint8_t
+{
+    Off    = ADS1220_IDAC_OFF,
+    uA10   = ADS1220_IDAC_10,
+    uA50   = ADS1220_IDAC_50,
+    uA100  = ADS1220_IDAC_100,
+    uA250  = ADS1220_IDAC_250,
+    uA500  = ADS1220_IDAC_500,
+    uA1000 = ADS1220_IDAC_1000,
+    uA1500 = ADS1220_IDAC_2000               // code 111 is 1500 uA in the datasheet
+};
+
+// I1MUX / I2MUX code, shifted into place by the builder
+enum class ADS1220IdacRoute : uint8_t
+{
+    Off   = 0,
+    AIN0  = 1,
+    AIN1  = 2,
+    AIN2  = 3,
+    AIN3  = 4,
+    REFP0 = 5,
+    REFN0 = 6
+};
+
+static constexpr bool ADS1220UsesAin0OrAin3(ADS1220Mux M)
+{
+    return M == ADS1220Mux::AIN0_AIN1 || M == ADS1220Mux::AIN0_AIN2 || M == ADS1220Mux::AIN0_AIN3 ||
+           M == ADS1220Mux::AIN1_AIN3 || M == ADS1220Mux::AIN2_AIN3 || M == ADS1220Mux::AIN1_AIN0 ||
+           M == ADS1220Mux::AIN3_AIN2 || M == ADS1220Mux::AIN0_AVSS || M == ADS1220Mux::AIN3_AVSS;
+}
+
+template <ADS1220Mux       Mux        = ADS1220Mux::AIN0_AIN1,
+          ADS1220Gain      Gain       = ADS1220Gain::x1,
+          bool             Bypass     = false,
+          ADS1220Rate      Rate       = ADS1220Rate::SPS20,
+          ADS1220Mode      Mode       = ADS1220Mode::Normal,
+          bool             Continuous = true,
+          ADS1220Vref      Vref       = ADS1220Vref::Internal,
+          ADS1220Rejection Rejection  = ADS1220Rejection::Off,
+          bool             PowerSwitch = false,
+          ADS1220Idac      Idac       = ADS1220Idac::Off,
+          ADS1220IdacRoute Idac1      = ADS1220IdacRoute::Off,
+          ADS1220IdacRoute Idac2      = ADS1220IdacRoute::Off,
+          bool             DrdyOnDout = false>
+struct ADS1220Config
+{
+    static_assert(!Bypass || (uint8_t)Gain <= (uint8_t)ADS1220Gain::x4,
+                  "ADS1220: the PGA can only be bypassed at gain 1, 2 or 4");
+    static_assert(Rejection == ADS1220Rejection::Off ||
+                  (Rate == ADS1220Rate::SPS20 && Mode != ADS1220Mode::Turbo),
+                  "ADS1220: 50/60Hz rejection only at 20 SPS normal mode (5 SPS duty-cycle)");
+    static_assert(Vref != ADS1220Vref::REFP1_REFN1 || !ADS1220UsesAin0OrAin3(Mux),
+                  "ADS1220: REFP1/REFN1 are the AIN0/AIN3 pins, they cannot be inputs as well");
+
+    static constexpr uint8_t Reg0 = (uint8_t)Mux | (uint8_t)Gain | (Bypass ? ADS1220_PGA_BYPASS : 0);
+    static constexpr uint8_t Reg1 = (uint8_t)Rate | (uint8_t)Mode | (Continuous ? ADS1220_CC : 0);
+    static constexpr uint8_t Reg2 = (uint8_t)Vref | (uint8_t)Rejection | (PowerSwitch ? ADS1220_PSW_SW : 0) | (uint8_t)Idac;
+    static constexpr uint8_t Reg3 = ((uint8_t)Idac1 << 5) | ((uint8_t)Idac2 << 2) | (DrdyOnDout ? ADS1220_DRDY_MODE : 0);
+
+    // Builder: each alias is the same configuration with one setting replaced
+    template <ADS1220Mux M> using WithMux =
+        ADS1220Config<M, Gain, Bypass, Rate, Mode, Continuous, Vref, Rejection, PowerSwitch, Idac, Idac1, Idac2, DrdyOnDout>;
+    template <ADS1220Gain G, bool B = false> using WithGain =
+        ADS1220Config<Mux, G, B, Rate, Mode, Continuous, Vref, Rejection, PowerSwitch, Idac, Idac1, Idac2, DrdyOnDout>;
+    template <ADS1220Rate R, ADS1220Mode O = ADS1220Mode::Normal> using WithRate =
+        ADS1220Config<Mux, Gain, Bypass, R, O, Continuous, Vref, Rejection, PowerSwitch, Idac, Idac1, Idac2, DrdyOnDout>;
+    template <bool C> using WithContinuous =
+        ADS1220Config<Mux, Gain, Bypass, Rate, Mode, C, Vref, Rejection, PowerSwitch, Idac, Idac1, Idac2, DrdyOnDout>;
+    template <ADS1220Vref V> using WithVref =
+        ADS1220Config<Mux, Gain, Bypass, Rate, Mode, Continuous, V, Rejection, PowerSwitch, Idac, Idac1, Idac2, DrdyOnDout>;
+    template <ADS1220Rejection J> using WithRejection =
+        ADS1220Config<Mux, Gain, Bypass, Rate, Mode, Continuous, Vref, J, PowerSwitch, Idac, Idac1, Idac2, DrdyOnDout>;
+    template <bool P> using WithPowerSwitch =
+        ADS1220Config<Mux, Gain, Bypass, Rate, Mode, Continuous, Vref, Rejection, P, Idac, Idac1, Idac2, DrdyOnDout>;
+    template <ADS1220Idac I, ADS1220IdacRoute I1, ADS1220IdacRoute I2 = ADS1220IdacRoute::Off> using WithIdac =
+        ADS1220Config<Mux, Gain, Bypass, Rate, Mode, Continuous, Vref, Rejection, PowerSwitch, I, I1, I2, DrdyOnDout>;
+    template <bool D> using WithDrdyOnDout =
+        ADS1220Config<Mux, Gain, Bypass, Rate, Mode, Continuous, Vref, Rejection, PowerSwitch, Idac, Idac1, Idac2, D>;
+
+    // Shadow update and one WREG of registers 0-3
+    static int Apply(ADS1220 &Device, bool DoVerify = false)
+    {
+        return Device.Apply(Reg0, Reg1, Reg2, Reg3, DoVerify);
+    }
+};
+
+// Bridge on AIN1-AIN2, ratiometric to the excitation on REFP1/REFN1: page-59 of SBAS501C,
+// ADS1220::Config() and the application's variants start from it
+typedef ADS1220Config<>
+    ::WithMux<ADS1220Mux::AIN1_AIN2>
+    ::WithGain<ADS1220Gain::x128>
+    ::WithVref<ADS1220Vref::REFP1_REFN1>
+    ::WithRejection<ADS1220Rejection::Both>
+    ::WithPowerSwitch<true> ADS1220Bridge;
+
+#endif /*ADS1220_CONFIG_H_*/
@@ -0,0 +1,102 @@
+#include "mbed.h"
+#include "ADS1220Decimator.h"
+
+ADS1220Decimator::ADS1220Decimator(uint16_t Ratio)
+{
+    if (SetRatio(Ratio) != ADS1220_NO_ERROR)
+        SetRatio(1);
+}
+
+void ADS1220Decimator::Attach(Callback<void(int32_t, uint32_t)> Output)
+{
+    output_ = Output;
+}
+
+int ADS1220Decimator::SetRatio(uint16_t Ratio)
+{
+    if (Ratio == 0 || Ratio > ADS1220_CIC_MAX_RATIO)
+        return ADS1220_ERROR;
+
+    ratio_ = Ratio;
+    norm_ = (int64_t)Ratio * Ratio * Ratio;
+    Reset();
+    return ADS1220_NO_ERROR;
+}
+
+uint16_t ADS1220Decimator::GetRatio(void)
+{
+    return ratio_;
+}
+
+void ADS1220Decimator::Reset(void)
+{
+    phase_ = 0;
+    memset(integ_, 0, sizeof(integ_));
+    memset(comb_, 0, sizeof(comb_));
+    fir_[0] = fir_[1] = 0;
+    settle_ = ADS1220_DECIM_SETTLE;
+}
+
+void ADS1220Decimator::Process(const ADS1220Block *Block)
+{
+    Process(Block->Data, Block->Timestamp, Block->Count);
+}
+
+void ADS1220Decimator::Process(const int32_t *Data, const uint32_t *Timestamp, uint16_t Count)
+{
+    // Locals, so the loop runs from registers
+    uint64_t i0 = integ_[0], i1 = integ_[1], i2 = integ_[2];
+    uint16_t phase = phase_;
+
+    for (uint16_t n = 0; n < Count; n++)
+    {
+        i0 += (uint64_t)(int64_t)Data[n];
+        i1 += i0;
+        i2 += i1;
+
+        if (++phase == ratio_)
+        {
+            integ_[0] = i0;
+            integ_[1] = i1;
+            integ_[2] = i2;
+            phase = 0;
+            Output(Timestamp ? Timestamp[n] : 0);
+        }
+    }
+
+    integ_[0] = i0;
+    integ_[1] = i1;
+    integ_[2] = i2;
+    phase_ = phase;
+}
+
+void ADS1220Decimator::Output(uint32_t Timestamp)
+{
+    uint64_t x = integ_[2], y;
+
+    // Combs, differential delay 1, modulo 2^64
+    for (int k = 0; k < 3; k++)
+    {
+        y = x - comb_[k];
+        comb_[k] = x;
+        x = y;
+    }
+
+    // Back to the 24 bit scale of the input; one 64 bit division per output
+    int32_t cic = (int32_t)((int64_t)x / norm_);
+
+    int64_t acc = (int64_t)ADS1220_FIR_TAP_EDGE * cic
+                + (int64_t)ADS1220_FIR_TAP_CENTER * fir_[0]
+                + (int64_t)ADS1220_FIR_TAP_EDGE * fir_[1];
+    fir_[1] = fir_[0];
+    fir_[0] = cic;
+
+    if (settle_)
+    {
+        settle_--;
+        return;
+    }
+
+    if (output_)
+        output_((int32_t)((acc + (1 << 14)) >> 15), Timestamp);
+}
@@ -0,0 +1,56 @@
+#ifndef ADS1220_DECIMATOR_H_
+#define ADS1220_DECIMATOR_H_
+
+#include "mbed.h"
+#include "ADS1220.h"
+
+#ifndef ADS1220_CIC_MAX_RATIO
+#define ADS1220_CIC_MAX_RATIO   1024    // 24 bit input + 3 * 10 bit growth fits in the 64 bit stages
+#endif
+
+// Compensating FIR, Q15, sum = 1.0: lifts the sinc^3 droop of the CIC near the output band edge
+#define ADS1220_FIR_TAP_EDGE    -4096
+#define ADS1220_FIR_TAP_CENTER  40960
+
+#define ADS1220_DECIM_SETTLE    4       // outputs dropped after Reset(): 3 for the CIC, 1 for the FIR
+
+/**
+ * Fixed-point decimation of an ADS1220 stream, e.g. 2 kSPS turbo mode down to 10, 50 or 100 Hz.
+ *
+ * A 3rd order CIC (integrators at the input rate, combs at the output rate) decimates by
+ * Ratio, is normalised by Ratio^3 and followed by a 3-tap compensating FIR at the output
+ * rate. The per-conversion work is three 64 bit additions, everything else runs once per
+ * output. The integrators wrap on purpose: the combs undo the wrap as long as the output
+ * fits, which ADS1220_CIC_MAX_RATIO guarantees.
+ *
+ * Process() is meant to be called from the stream's block callback; the output callback
+ * runs on the same thread with the filtered value and the timestamp of the last conversion
+ * that went into it.
+ */
+class ADS1220Decimator
+{
+public:
+    ADS1220Decimator(uint16_t Ratio);
+
+    void Attach(Callback<void(int32_t, uint32_t)> Output);
+    int SetRatio(uint16_t Ratio);            // also resets the filter
+    uint16_t GetRatio(void);
+    void Reset(void);
+
+    void Process(const ADS1220Block *Block);
+    void Process(const int32_t *Data, const uint32_t *Timestamp, uint16_t Count);
+
+private:
+    void Output(uint32_t Timestamp);
+
+    Callback<void(int32_t, uint32_t)> output_;
+    uint16_t ratio_;
+    uint16_t phase_;                         // conversions into the current output
+    int64_t  norm_;                          // Ratio^3, the CIC gain
+    uint64_t integ_[3];
+    uint64_t comb_[3];                       // previous input of each comb
+    int32_t  fir_[2];                        // previous CIC outputs, newest first
+    uint8_t  settle_;
+};
+
+#endif /*ADS1220_DECIMATOR_H_*/
@@ -0,0 +1,64 @@
+#include "mbed.h"
+#include "ADS1220OffsetTracker.h"
+
+ADS1220OffsetTracker::ADS1220OffsetTracker(ADS1220 &Device, uint32_t IntervalMs) :
+    device_(Device),
+    intervalUs_(IntervalMs * 1000)
+{
+    Reset();
+}
+
+void ADS1220OffsetTracker::Reset(void)
+{
+    lastRequest_ = 0;
+    requested_ = false;
+    offset_ = 0;
+    samples_ = 0;
+}
+
+void ADS1220OffsetTracker::Process(const ADS1220Block *Block)
+{
+    for (uint16_t i = 0; i < Block->Count; i++)
+    {
+        if (!(Block->Tag[i] & ADS1220_TAG_OFFSET) || (Block->Tag[i] & ADS1220_TAG_UNSETTLED))
+            continue;
+
+        int64_t Reading = (int64_t)Block->Data[i] << ADS1220_OFFSET_SHIFT;
+        if (samples_ == 0)
+            offset_ = Reading;
+        else
+            offset_ += (Reading - offset_) >> ADS1220_OFFSET_SHIFT;
+        samples_++;
+    }
+
+    // Paced by the conversion timestamps, no timer of its own
+    if (Block->Count == 0)
+        return;
+    uint32_t Now = Block->Timestamp[Block->Count - 1];
+    if (!requested_ || (uint32_t)(Now - lastRequest_) >= intervalUs_)
+    {
+        device_.RequestOffsetSample();
+        lastRequest_ = Now;
+        requested_ = true;
+    }
+}
+
+int32_t ADS1220OffsetTracker::Correct(int32_t Raw)
+{
+    return Raw - GetOffset();
+}
+
+int32_t ADS1220OffsetTracker::GetOffset(void)
+{
+    return (int32_t)(offset_ >> ADS1220_OFFSET_SHIFT);
+}
+
+bool ADS1220OffsetTracker::IsValid(void)
+{
+    return samples_ > 0;
+}
+
+uint32_t ADS1220OffsetTracker::GetSampleCount(void)
+{
+    return samples_;
+}
@@ -0,0 +1,42 @@
+#ifndef ADS1220_OFFSET_TRACKER_H_
+#define ADS1220_OFFSET_TRACKER_H_
+
+#include "mbed.h"
+#include "ADS1220.h"
+
+#ifndef ADS1220_OFFSET_SHIFT
+#define ADS1220_OFFSET_SHIFT    3       // IIR weight of a new shorted-input reading: 1/8
+#endif
+
+/**
+ * Background offset tracking of a streaming ADS1220.
+ *
+ * Every Interval a shorted-input conversion is requested from the driver
+ * (ADS1220::RequestOffsetSample()); the result, tagged ADS1220_TAG_OFFSET in the
+ * block, goes through a first order IIR and Correct() subtracts the estimate from
+ * the input conversions. The first reading seeds the filter. Call Process() from
+ * the stream's block callback, on the same thread as the driver's transfers; the
+ * offset holds for the gain of scan entry 0.
+ */
+class ADS1220OffsetTracker
+{
+public:
+    ADS1220OffsetTracker(ADS1220 &Device, uint32_t IntervalMs);
+
+    void Process(const ADS1220Block *Block);
+    int32_t Correct(int32_t Raw);            // Raw minus the offset estimate
+    int32_t GetOffset(void);
+    bool IsValid(void);                      // at least one shorted-input reading
+    uint32_t GetSampleCount(void);
+    void Reset(void);
+
+private:
+    ADS1220 &device_;
+    uint32_t intervalUs_;
+    uint32_t lastRequest_;                   // us_ticker timestamp of the last request
+    bool requested_;                         // lastRequest_ is set
+    int64_t offset_;                         // estimate << ADS1220_OFFSET_SHIFT
+    uint32_t samples_;
+};
+
+#endif /*ADS1220_OFFSET_TRACKER_H_*/
@@ -17,11 +17,28 @@
 #include "ADS1231.h"
 
 
-ADS1231::ADS1231 ( PinName SCLK, PinName DOUT )
+ADS1231::ADS1231 ( PinName SCLK, PinName DOUT, SpiBitstream* transport )
     : _SCLK                 ( SCLK )
     , _DOUT                 ( DOUT )
+    , _TRANSPORT            ( transport )
+    , _TIMEOUT_MS           ( ADS1231_TIMEOUT_MS )
+    , _DRDY_SEEN            ( false )
+    , _MISSED               ( 0 )
+    , _ADS1231_SCALE        ( ADS1231_SCALE_kg )
+    , _ADS1231_USER_CALIBATED_MASS ( 0 )
+    , _CAL_VALID            ( false )
+    , _CAL_M                ( 0 )
+    , _CAL_B                ( 0 )
+    , _CAL_C_ZS             ( 0 )
+    , _CAL_C_FS             ( 0 )
+    , _CAL_W_T              ( 0 )
+    , _CAL_REQUEST          ( false )
+    , _CAL_TIME_MS          ( 0 )
+    , _CAL_WAIT_MS          ( 0 )
+    , _NEXT_FLAGS           ( 0 )
 {
-
+    _DOUT.fall ( callback ( this, &ADS1231::_ADS1231_DataReadyIRQ ) );
+    _DOUT.disable_irq ();                                                       // Only armed while somebody is waiting
 }
 
 
@@ -56,10 +73,18 @@ ADS1231::~ADS1231()
  */
 ADS1231::ADS1231_status_t  ADS1231::ADS1231_Reset   ( void )
 {
+    if ( _TRANSPORT != NULL )
+        _TRANSPORT->release();                                                  // The clock line is held through GPIO
+
     _SCLK  =  ADS1231_PIN_HIGH;
     wait_us ( 52 );                                                             // Datasheet p15. At least 26us ( Security Factor: 2*26us = 52us )
     _SCLK  =  ADS1231_PIN_LOW;
 
+    _DRDY_SEEN   =   false;                                                     // The device has to prove it is there again
+    _MISSED      =   0;
+    _CAL_REQUEST =   false;
+    _CAL_WAIT_MS =   0;
+
 
 
     if ( _DOUT == ADS1231_PIN_HIGH )
@@ -92,6 +117,9 @@ ADS1231::ADS1231_status_t  ADS1231::ADS1231_Reset   ( void )
  */
 ADS1231::ADS1231_status_t  ADS1231::ADS1231_PowerDown   ( void )
 {
+    if ( _TRANSPORT != NULL )
+        _TRANSPORT->release();                                                  // The clock line is held through GPIO
+
     _SCLK  =  ADS1231_PIN_HIGH;
     wait_us ( 52 );                                                             // Datasheet p15. At least 26us ( Security Factor: 2*26us = 52us )
 
@@ -105,6 +133,214 @@ ADS1231::ADS1231_status_t  ADS1231::ADS1231_PowerDown   ( void )
 
 
 
+/**
+ * @brief       ADS1231_GetDataOutputStatus   ( void )
+ *
+ * @details     It checks whether a conversion is ready to be read.
+ *
+ * @param[in]    NaN.
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       ADS1231_DATA_READY if DOUT is low, ADS1231_DATA_BUSY otherwise.
+ *
+ *
+ * @pre         DOUT goes low when the new data is ready and returns high after the 25th SCLK.
+ * @warning     NaN.
+ */
+ADS1231::ADS1231_data_output_status_t  ADS1231::ADS1231_GetDataOutputStatus   ( void )
+{
+    if ( _DOUT == ADS1231_PIN_HIGH )
+        return   ADS1231_DATA_BUSY;
+    else
+        return   ADS1231_DATA_READY;
+}
+
+
+
+/**
+ * @brief       ADS1231_WaitDataReady   ( void )
+ *
+ * @details     It waits until DOUT goes low. The calling thread sleeps on an
+ *              EventFlags set by the DOUT falling edge, so the core can enter
+ *              sleep between conversions instead of spinning.
+ *
+ * @param[in]    NaN.
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       ADS1231_SUCCESS:          New data is ready.
+ *               ADS1231_TIMEOUT:          No data within the timeout but the device answered before.
+ *               ADS1231_DEVICE_NOT_FOUND: No data-ready edge since reset or ADS1231_MISSING_AFTER timeouts in a row.
+ *
+ *
+ * @pre         The timeout is real time ( ADS1231_SetTimeout ), it does not depend on the core clock.
+ * @warning     From interrupt context it cannot block, so it falls back to polling DOUT against us_ticker.
+ */
+ADS1231::ADS1231_status_t  ADS1231::ADS1231_WaitDataReady   ( void )
+{
+    uint64_t    myDeadline;
+    uint64_t    myNow;
+    uint32_t    myFlags;
+
+
+    if ( core_util_is_isr_active () )
+        return   _ADS1231_PollDataReady ();
+
+
+    myDeadline   =   Kernel::get_ms_count () + _TIMEOUT_MS + _CAL_WAIT_MS;
+
+    _DRDY_FLAGS.clear ( ADS1231_FLAG_DRDY );
+    _DOUT.enable_irq ();
+
+    // The edge may have happened before the IRQ was armed, check the level first
+    while ( _DOUT == ADS1231_PIN_HIGH ) {
+        myNow    =   Kernel::get_ms_count ();
+        if ( myNow >= myDeadline )
+            break;
+
+        myFlags  =   _DRDY_FLAGS.wait_any ( ADS1231_FLAG_DRDY, ( uint32_t )( myDeadline - myNow ) );
+        if ( myFlags & osFlagsError )
+            break;
+    }
+
+    _DOUT.disable_irq ();                                                       // Data bits toggle DOUT, no interrupts during the readout
+
+
+    if ( _DOUT == ADS1231_PIN_HIGH ) {
+        if ( _MISSED < 0xFF )
+            _MISSED++;
+
+        if ( ( _DRDY_SEEN == false ) || ( _MISSED >= ADS1231_MISSING_AFTER ) )
+            return   ADS1231_DEVICE_NOT_FOUND;
+        else
+            return   ADS1231_TIMEOUT;
+    }
+
+    _DRDY_SEEN   =   true;
+    _MISSED      =   0;
+    _CAL_WAIT_MS =   0;                                                         // The offset calibration, if any, is over
+
+    return   ADS1231_SUCCESS;
+}
+
+
+
+/**
+ * @brief       ADS1231_SetTimeout   ( uint32_t )
+ *
+ * @details     It sets the data-ready timeout.
+ *
+ * @param[in]    myTimeout_ms:   Timeout in milliseconds. Settling after reset takes 4 conversions
+ *                               ( 400ms @ 10SPS, 50ms @ 80SPS ).
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       NaN.
+ *
+ *
+ * @pre         NaN.
+ * @warning     NaN.
+ */
+void  ADS1231::ADS1231_SetTimeout ( uint32_t myTimeout_ms )
+{
+    _TIMEOUT_MS  =   myTimeout_ms;
+}
+
+
+
+/**
+ * @brief       ADS1231_GetTimeout   ( void )
+ *
+ * @details     It gets the data-ready timeout.
+ *
+ * @param[in]    NaN.
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       Timeout in milliseconds.
+ *
+ *
+ * @pre         NaN.
+ * @warning     NaN.
+ */
+uint32_t  ADS1231::ADS1231_GetTimeout ( void )
+{
+    return   _TIMEOUT_MS;
+}
+
+
+
+/**
+ * @brief       _ADS1231_DataReadyIRQ   ( void )
+ *
+ * @details     DOUT falling edge: a new conversion is ready.
+ *
+ * @param[in]    NaN.
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       NaN.
+ *
+ *
+ * @pre         Interrupt context.
+ * @warning     NaN.
+ */
+void  ADS1231::_ADS1231_DataReadyIRQ ( void )
+{
+    _DRDY_FLAGS.set ( ADS1231_FLAG_DRDY );
+}
+
+
+
+/**
+ * @brief       _ADS1231_PollDataReady   ( void )
+ *
+ * @details     Busy-wait version of ADS1231_WaitDataReady for callers that cannot block.
+ *
+ * @param[in]    NaN.
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       Same as ADS1231_WaitDataReady.
+ *
+ *
+ * @pre         NaN.
+ * @warning     It keeps the core awake for up to the whole timeout.
+ */
+ADS1231::ADS1231_status_t  ADS1231::_ADS1231_PollDataReady ( void )
+{
+    uint32_t    myStart  =   us_ticker_read ();
+    uint32_t    myLimit  =   ( _TIMEOUT_MS + _CAL_WAIT_MS ) * 1000U;
+
+
+    while ( _DOUT == ADS1231_PIN_HIGH ) {
+        if ( ( uint32_t )( us_ticker_read () - myStart ) >= myLimit ) {
+            if ( _MISSED < 0xFF )
+                _MISSED++;
+
+            if ( ( _DRDY_SEEN == false ) || ( _MISSED >= ADS1231_MISSING_AFTER ) )
+                return   ADS1231_DEVICE_NOT_FOUND;
+            else
+                return   ADS1231_TIMEOUT;
+        }
+    }
+
+    _DRDY_SEEN   =   true;
+    _MISSED      =   0;
+    _CAL_WAIT_MS =   0;                                                         // The offset calibration, if any, is over
+
+    return   ADS1231_SUCCESS;
+}
+
+
+
 /**
  * @brief       ADS1231_ReadRawData   ( Vector_count_t*, uint32_t )
  *
@@ -126,13 +362,58 @@ ADS1231::ADS1231_status_t  ADS1231::ADS1231_PowerDown   ( void )
  */
 ADS1231::ADS1231_status_t  ADS1231::ADS1231_ReadRawData    ( Vector_count_t* myNewRawData, uint8_t num_avg )
 {
-    uint32_t i           =   0;                                                 // Counter and timeout variable
+    Vector_stats_t  myStats;
+
+
+
+    return   ADS1231_ReadRawStats ( myNewRawData, &myStats, num_avg );
+}
+
+
+
+/**
+ * @brief       ADS1231_ReadRawStats   ( Vector_count_t*, Vector_stats_t*, uint8_t )
+ *
+ * @details     It reads a burst of conversions and delivers their mean, variance, minimum and maximum.
+ *
+ * @param[in]    num_avg:         How many conversions are read ( 1 to 255 ).
+ *
+ * @param[out]   myNewRawData:    myRawValue: the rounded mean of the burst.
+ * @param[out]   myStats:         Statistics of the burst, in ADC codes.
+ *
+ *
+ * @return       Status of ADS1231_ReadRawStats.
+ *
+ *
+ * @pre         Integer only: the codes are shifted by the first conversion ( K ) so that
+ *              the sum of squares of ( x - K ) fits in 64 bits ( 255 * 2^48 < 2^56 ), and
+ *              variance = ( S2 - S1^2 / n ) / ( n - 1 ) is exact to one count^2.
+ * @warning     NaN.
+ */
+ADS1231::ADS1231_status_t  ADS1231::ADS1231_ReadRawStats   ( Vector_count_t* myNewRawData, Vector_stats_t* myStats, uint8_t num_avg )
+{
+    uint32_t i           =   0;                                                 // Counter variable
     uint32_t ii          =   0;                                                 // Counter variable
     uint32_t myAuxData   =   0;
+    uint8_t  myPulses    =   25;                                                // 24 data bits + 1 to release DOUT ( + 1: offset calibration )
+    uint32_t myShift     =   0;                                                 // K: first conversion of the burst
+    int64_t  mySum       =   0;                                                 // S1 = sum ( x - K )
+    uint64_t mySumSq     =   0;                                                 // S2 = sum ( x - K )^2
+    uint64_t myAbsSum    =   0;
+    int32_t  myDelta     =   0;
+    ADS1231_status_t aux;
 
 
 
-    myNewRawData->myRawValue    =   0;                                          // Reset variable at the beginning
+    myStats->myMean      =   0;                                                 // Reset variables at the beginning
+    myStats->myVariance  =   0;
+    myStats->myMin       =   0xFFFFFFFF;
+    myStats->myMax       =   0;
+    myStats->mySamples   =   0;
+    myStats->myFlags     =   0;
+
+    if ( num_avg == 0 )
+        return   ADS1231_FAILURE;
 
     // Start collecting the new measurement as many as num_avg
     for ( ii = 0; ii < num_avg; ii++ ) {
@@ -140,41 +421,90 @@ ADS1231::ADS1231_status_t  ADS1231::ADS1231_ReadRawData    ( Vector_count_t* myN
         myAuxData    =   0;
 
         // Wait until the device is ready or timeout
-        i        =   23232323;
         _SCLK  =  ADS1231_PIN_LOW;
-        while ( ( _DOUT == ADS1231_PIN_HIGH ) && ( --i ) );
+        aux      =   ADS1231_WaitDataReady ();
 
         // Check if something is wrong with the device because of the timeout
-        if ( i < 1 )
-            return   ADS1231_FAILURE;
+        if ( aux != ADS1231_SUCCESS )
+            return   aux;
+
+        // A pending offset calibration rides on the last conversion of the burst
+        if ( ( _CAL_REQUEST == true ) && ( ii == ( uint32_t )( num_avg - 1 ) ) )
+            myPulses     =   26;
+
+
+        if ( _TRANSPORT != NULL ) {
+            // Read the data and release the bus in a single SPI burst
+            myAuxData    =   _TRANSPORT->read ( myPulses, 24 );
+        } else {
+            // Read the data. An interrupt inside a high pulse could hold SCLK high past the 26us
+            // power-down time, so only the pulses are protected; other ISRs run while SCLK is low
+            for ( i = 0; i < 24; i++ ) {
+                core_util_critical_section_enter ();
+                // wait_us ( 1 );                                               // Datasheet p13.  t_SCLK ( Min. 100ns )
+                _SCLK  =  ADS1231_PIN_HIGH;
+                // wait_us ( 1 );                                               // Datasheet p13.  t_SCLK ( Min. 100ns )
+                myAuxData    <<=     1;
+                _SCLK  =  ADS1231_PIN_LOW;
+                core_util_critical_section_exit ();
+
+                // High or Low bit
+                if ( _DOUT == ADS1231_PIN_HIGH )
+                    myAuxData++;
+            }
+
+            // Last bit to release the bus ( and the 26th to start the offset calibration )
+            for ( i = 24; i < myPulses; i++ ) {
+                core_util_critical_section_enter ();
+                // wait_us ( 1 );                                               // Datasheet p13.  t_SCLK ( Min. 100ns )
+                _SCLK  =  ADS1231_PIN_HIGH;
+                // wait_us ( 1 );                                               // Datasheet p13.  t_SCLK ( Min. 100ns )
+                _SCLK  =  ADS1231_PIN_LOW;
+                core_util_critical_section_exit ();
+            }
+        }
 
 
-        // Read the data
-        for ( i = 0; i < 24; i++ ) {
-            // wait_us ( 1 );                                                   // Datasheet p13.  t_SCLK ( Min. 100ns )
-            _SCLK  =  ADS1231_PIN_HIGH;
-            // wait_us ( 1 );                                                   // Datasheet p13.  t_SCLK ( Min. 100ns )
-            myAuxData    <<=     1;
-            _SCLK  =  ADS1231_PIN_LOW;
+        // Offset binary: 0 is the most negative code
+        myAuxData   ^=   0x800000;
 
-            // High or Low bit
-            if ( _DOUT == ADS1231_PIN_HIGH )
-                myAuxData++;
-        }
+        if ( ii == 0 )
+            myShift  =   myAuxData;
 
-        // Last bit to release the bus
-        // wait_us ( 1 );                                                       // Datasheet p13.  t_SCLK ( Min. 100ns )
-        _SCLK  =  ADS1231_PIN_HIGH;
-        // wait_us ( 1 );                                                       // Datasheet p13.  t_SCLK ( Min. 100ns )
-        _SCLK  =  ADS1231_PIN_LOW;
+        if ( myAuxData < myStats->myMin )
+            myStats->myMin   =   myAuxData;
+        if ( myAuxData > myStats->myMax )
+            myStats->myMax   =   myAuxData;
+
+        myDelta      =   ( int32_t )( myAuxData - myShift );                    // | x - K | < 2^24
+        mySum       +=   myDelta;
+        mySumSq     +=   ( uint64_t )( ( int64_t )myDelta * myDelta );
+    }
 
 
-        // Update data to get the average
-        myAuxData                  ^=    0x800000;
-        myNewRawData->myRawValue   +=    myAuxData;
+    // Mean, rounded to the nearest code
+    if ( mySum >= 0 )
+        myStats->myMean  =   myShift + ( uint32_t )( ( mySum + num_avg / 2 ) / num_avg );
+    else
+        myStats->myMean  =   myShift - ( uint32_t )( ( -mySum + num_avg / 2 ) / num_avg );
+
+    // Sample variance, S1^2 < 2^64 only fits unsigned
+    if ( num_avg > 1 ) {
+        myAbsSum             =   ( uint64_t )( ( mySum < 0 ) ? -mySum : mySum );
+        myStats->myVariance  =   ( mySumSq - ( myAbsSum * myAbsSum ) / num_avg ) / ( num_avg - 1 );
     }
 
-    myNewRawData->myRawValue    /=    ( float )num_avg;
+    myStats->mySamples       =   num_avg;
+
+    // The burst before the calibration is clean, the next one starts from the new offset
+    myStats->myFlags         =   _NEXT_FLAGS;
+    _NEXT_FLAGS              =   0;
+    if ( myPulses == 26 ) {
+        _CAL_REQUEST         =   false;
+        _CAL_WAIT_MS         =   _CAL_TIME_MS;
+        _NEXT_FLAGS          =   ADS1231_STATS_OFFSET_CAL;
+    }
+    myNewRawData->myRawValue =   myStats->myMean;
 
 
 
@@ -218,10 +548,7 @@ ADS1231::ADS1231_status_t  ADS1231::ADS1231_ReadData_WithCalibratedMass(Vector_c
 
 
 
-    if ( aux == ADS1231_SUCCESS )
-        return   ADS1231_SUCCESS;
-    else
-        return   ADS1231_FAILURE;
+    return   aux;                                                               // Keep TIMEOUT / DEVICE_NOT_FOUND visible to the caller
 }
 
 
@@ -258,10 +585,7 @@ ADS1231::ADS1231_status_t  ADS1231::ADS1231_ReadData_WithoutMass   ( Vector_coun
 
 
 
-    if ( aux == ADS1231_SUCCESS )
-        return   ADS1231_SUCCESS;
-    else
-        return   ADS1231_FAILURE;
+    return   aux;                                                               // Keep TIMEOUT / DEVICE_NOT_FOUND visible to the caller
 }
 
 
@@ -291,15 +615,55 @@ ADS1231::ADS1231_status_t  ADS1231::ADS1231_ReadData_WithoutMass   ( Vector_coun
  * @warning     NaN.
  */
 ADS1231::Vector_mass_t  ADS1231::ADS1231_CalculateMass ( Vector_count_t* myNewRawData, float myCalibratedMass, ADS1231_scale_t myScaleCalibratedMass )
+{
+    Vector_mass_t w;
+
+
+    // Any change of zero, span, tare, calibration mass or scale invalidates the cached model
+    if ( ( _CAL_VALID == false )                                                        ||
+         ( myNewRawData->myRawValue_WithoutCalibratedMass  !=  _CAL_C_ZS )               ||
+         ( myNewRawData->myRawValue_WithCalibratedMass     !=  _CAL_C_FS )               ||
+         ( myNewRawData->myRawValue_TareWeight             !=  _CAL_W_T )                ||
+         ( myCalibratedMass                                !=  _ADS1231_USER_CALIBATED_MASS ) ||
+         ( myScaleCalibratedMass                           !=  _ADS1231_SCALE ) )
+        _ADS1231_UpdateCalibration ( myNewRawData, myCalibratedMass, myScaleCalibratedMass );
+
+
+    // Calculate the mass ( w ) = m * c + w_zs - w_t
+    w.myMass   =    ( _CAL_M * ( float )myNewRawData->myRawValue ) + _CAL_B;         // The mass according to myScaleCalibratedMass
+
+
+
+    return   w;
+}
+
+
+
+/**
+ * @brief       _ADS1231_UpdateCalibration ( Vector_count_t*, float, ADS1231_scale_t )
+ *
+ * @details     It computes the calibration model used by ADS1231_CalculateMass.
+ *
+ * @param[in]    myNewRawData:              Zero, span and tare of the calibration.
+ * @param[in]    myCalibratedMass:          A known value for the calibrated mass.
+ * @param[in]    myScaleCalibratedMass:     The range of the calibrated mass ( kg, g, mg or ug ).
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       NaN.
+ *
+ *
+ * @pre         It only runs when the calibration changes, so the division is not paid per sample.
+ * @warning     NaN.
+ */
+void  ADS1231::_ADS1231_UpdateCalibration ( Vector_count_t* myNewRawData, float myCalibratedMass, ADS1231_scale_t myScaleCalibratedMass )
 {
     // Terminology by Texas Instruments: sbau175a.pdf, p8 2.1.1 Calculation of Mass
     float m, w_zs;
     float c_zs, w_fs, c_fs, w_t;
-    float c = 0;
     float myFactor   =   1.0;
 
-    Vector_mass_t w;
-
 
     // Adapt the scale ( kg as reference )
     switch ( myScaleCalibratedMass ) {
@@ -334,21 +698,18 @@ ADS1231::Vector_mass_t  ADS1231::ADS1231_CalculateMass ( Vector_count_t* myNewRa
     // Calculate the zero-scale mass ( w_zs )
     w_zs    =    - ( m * c_zs );
 
-
-    // Calculate the mass ( w )
     w_t     =    myNewRawData->myRawValue_TareWeight;                           // ADC code taken without any mass after the system is calibrated;
-    c       =    myNewRawData->myRawValue;                                      // The ADC code
-
-    w.myMass   =    ( m * c ) + w_zs - w_t;                                     // The mass according to myScaleCalibratedMass
 
 
     // Update Internal Parameters
+    _CAL_M                         =   m;
+    _CAL_B                         =   w_zs - w_t;
+    _CAL_C_ZS                      =   c_zs;
+    _CAL_C_FS                      =   c_fs;
+    _CAL_W_T                       =   w_t;
+    _CAL_VALID                     =   true;
     _ADS1231_USER_CALIBATED_MASS   =   myCalibratedMass;
     _ADS1231_SCALE                 =   myScaleCalibratedMass;
-
-
-
-    return   w;
 }
 
 
@@ -405,10 +766,7 @@ ADS1231::ADS1231_status_t  ADS1231::ADS1231_SetAutoTare(float myCalibratedMass,
 
 
 
-    if ( aux == ADS1231_SUCCESS )
-        return   ADS1231_SUCCESS;
-    else
-        return   ADS1231_FAILURE;
+    return   aux;                                                               // Keep TIMEOUT / DEVICE_NOT_FOUND visible to the caller
 }
 
 
@@ -488,3 +846,30 @@ ADS1231::Vector_voltage_t  ADS1231::ADS1231_CalculateVoltage ( Vector_count_t* m
 
     return   v;
 }
+
+
+
+/**
+ * @brief       ADS1231_SetTransport ( SpiBitstream* )
+ *
+ * @details     It selects how the bits are clocked out.
+ *
+ * @param[in]    transport:                 SPI bit-stream transport wired to SCLK/DOUT, or NULL for GPIO bit-banging.
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       NaN.
+ *
+ *
+ * @pre         The SPI transport drives SCLK from MOSI and captures DOUT on MISO; the 25th release clock
+ *              is part of the same burst.
+ * @warning     NaN.
+ */
+void  ADS1231::ADS1231_SetTransport ( SpiBitstream* transport )
+{
+    if ( _TRANSPORT != NULL )
+        _TRANSPORT->release();
+
+    _TRANSPORT   =   transport;
+}
@@ -17,6 +17,7 @@
 #define ADS1231_H
 
 #include "mbed.h"
+#include "SpiBitstream.h"
 
 
 /**
@@ -147,6 +148,15 @@ public:
     typedef struct {
         float myVoltage;
     } Vector_voltage_t;
+
+    typedef struct {
+        uint32_t myMean;                              /*!<  Rounded mean of the burst ( ADC code )                               */
+        uint64_t myVariance;                          /*!<  Sample variance ( ADC code^2 ), 0 for a single conversion            */
+        uint32_t myMin;                               /*!<  Lowest code of the burst                                             */
+        uint32_t myMax;                               /*!<  Highest code of the burst                                            */
+        uint8_t  mySamples;                           /*!<  Conversions in the burst                                             */
+        uint8_t  myFlags;                             /*!<  ADS1231_STATS_xxx                                                    */
+    } Vector_stats_t;
 #endif
 
 
@@ -156,10 +166,22 @@ public:
       */
 #define ADS1231_PIN_HIGH           0x01               /*!<   Pin 'HIGH'                                                       */
 #define ADS1231_PIN_LOW            0x00               /*!<   Pin 'LOW'                                                        */
+#define ADS1231_STATS_OFFSET_CAL   0x01               /*!<   Vector_stats_t: first burst after an offset calibration          */
+#define ADS1231_FLAG_DRDY          0x01               /*!<   EventFlags bit set by the DOUT falling edge                      */
+
+#ifndef ADS1231_TIMEOUT_MS
+#define ADS1231_TIMEOUT_MS         500                /*!<   Data-ready timeout: 10 SPS settling ( 4 conversions ) + margin   */
+#endif
+
+#ifndef ADS1231_MISSING_AFTER
+#define ADS1231_MISSING_AFTER      3                  /*!<   Consecutive timeouts before the device is reported as missing    */
+#endif
 
     typedef enum {
         ADS1231_SUCCESS     =       0,
         ADS1231_FAILURE     =       1,
+        ADS1231_TIMEOUT     =       2,                /*!<  The device answered before but this conversion is late.           */
+        ADS1231_DEVICE_NOT_FOUND =  3                 /*!<  No data-ready edge seen since reset ( wiring / power ).             */
     } ADS1231_status_t;
 
 
@@ -169,8 +191,9 @@ public:
       *
       * @param sclk             ADS1231 Power down control (high active) and serial clock input
       * @param dout             ADS1231 Serial data output
+      * @param transport        Optional SPI bit-stream transport wired to the same pins ( NULL: GPIO bit-banging )
       */
-    ADS1231 ( PinName SCLK, PinName DOUT );
+    ADS1231 ( PinName SCLK, PinName DOUT, SpiBitstream* transport = NULL );
 
     /** Delete ADS1231 object.
      */
@@ -184,10 +207,30 @@ public:
      */
     ADS1231_status_t  ADS1231_PowerDown                     ( void );
 
+    /** It checks whether a conversion is ready to be read.
+     */
+    ADS1231_data_output_status_t  ADS1231_GetDataOutputStatus ( void );
+
+    /** It waits ( sleeping ) until DOUT signals a new conversion or the timeout expires.
+     */
+    ADS1231_status_t  ADS1231_WaitDataReady                 ( void );
+
+    /** It sets the data-ready timeout in milliseconds.
+     */
+    void  ADS1231_SetTimeout                              ( uint32_t myTimeout_ms );
+
+    /** It gets the data-ready timeout in milliseconds.
+     */
+    uint32_t  ADS1231_GetTimeout                          ( void );
+
     /** It reads raw data from the device.
      */
     ADS1231_status_t  ADS1231_ReadRawData                   ( Vector_count_t* myNewRawData, uint8_t num_avg );
 
+    /** It reads a burst of raw data and its mean, variance, minimum and maximum.
+     */
+    ADS1231_status_t  ADS1231_ReadRawStats                  ( Vector_count_t* myNewRawData, Vector_stats_t* myStats, uint8_t num_avg );
+
     /** It reads raw data with an user-specified calibrated mass.
      */
     ADS1231_status_t  ADS1231_ReadData_WithCalibratedMass   ( Vector_count_t* myNewRawData, uint8_t num_avg );
@@ -212,14 +255,40 @@ public:
      */
     Vector_voltage_t  ADS1231_CalculateVoltage            ( Vector_count_t* myNewRawData, float myVoltageReference );
 
+    /** It selects how the bits are clocked out ( NULL: GPIO bit-banging ).
+     */
+    void  ADS1231_SetTransport                            ( SpiBitstream* transport );
+
 
 
 
 private:
     DigitalOut              _SCLK;
-    DigitalIn               _DOUT;
+    InterruptIn             _DOUT;
+    SpiBitstream*           _TRANSPORT;
+    EventFlags              _DRDY_FLAGS;
+    uint32_t                _TIMEOUT_MS;
+    bool                    _DRDY_SEEN;
+    uint8_t                 _MISSED;
     ADS1231_scale_t         _ADS1231_SCALE;
     float                   _ADS1231_USER_CALIBATED_MASS;
+    bool                    _CAL_VALID;                                         // Cached model: mass = _CAL_M * code + _CAL_B
+    float                   _CAL_M;
+    float                   _CAL_B;
+    float                   _CAL_C_ZS;                                          // Inputs the model was computed from
+    float                   _CAL_C_FS;
+    float                   _CAL_W_T;
+
+protected:
+    bool                    _CAL_REQUEST;                                       // End the next burst with 26 SCLKs ( offset calibration )
+    uint32_t                _CAL_TIME_MS;                                       // Calibration time added to the wait that follows it
+    uint32_t                _CAL_WAIT_MS;
+    uint8_t                 _NEXT_FLAGS;                                        // Vector_stats_t.myFlags of the next burst
+
+private:
+    void                    _ADS1231_DataReadyIRQ  ( void );
+    ADS1231_status_t        _ADS1231_PollDataReady ( void );
+    void                    _ADS1231_UpdateCalibration ( Vector_count_t* myNewRawData, float myCalibratedMass, ADS1231_scale_t myScaleCalibratedMass );
 };
 
 #endif
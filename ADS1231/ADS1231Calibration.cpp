@@ -0,0 +1,206 @@
+#include "ADS1231Calibration.h"
+
+
+ADS1231Calibration::ADS1231Calibration(ADS1231 &adc, EventQueue *queue, ADS1231::Vector_count_t *data) :
+    adc_(adc),
+    queue_(queue),
+    data_(data),
+    phase_(PHASE_IDLE),
+    remaining_(0),
+    event_(0),
+    mass_(0),
+    scale_(ADS1231::ADS1231_SCALE_kg),
+    sum_(0),
+    count_(0) {
+}
+
+
+void ADS1231Calibration::attach_progress(Callback<void(Phase, uint16_t)> cb) {
+    on_progress_ = cb;
+}
+
+
+void ADS1231Calibration::attach_done(Callback<void(ADS1231::ADS1231_status_t)> cb) {
+    on_done_ = cb;
+}
+
+
+bool ADS1231Calibration::start(float mass, ADS1231::ADS1231_scale_t scale) {
+    if (is_running()) {
+        return false;
+    }
+
+    mass_ = mass;
+    scale_ = scale;
+    phase_ = PHASE_RESET;
+    remaining_ = 0;
+    event_ = queue_->call(this, &ADS1231Calibration::step);
+    return true;
+}
+
+
+void ADS1231Calibration::abort() {
+    phase_ = PHASE_IDLE;  // a step already running sees it and stops
+    if (event_) {
+        queue_->cancel(event_);
+        event_ = 0;
+    }
+}
+
+
+ADS1231Calibration::Phase ADS1231Calibration::get_phase() {
+    return phase_;
+}
+
+
+bool ADS1231Calibration::is_running() {
+    Phase phase = phase_;
+    return phase != PHASE_IDLE && phase != PHASE_DONE && phase != PHASE_FAILED;
+}
+
+
+void ADS1231Calibration::enter(Phase phase, uint16_t remaining) {
+    phase_ = phase;
+    remaining_ = remaining;
+    sum_ = 0;
+    count_ = 0;
+    progress();
+
+    switch (phase) {
+        case PHASE_REMOVE_MASS:
+        case PHASE_PUT_MASS:
+        case PHASE_REMOVE_MASS_TARE:
+            event_ = queue_->call_in(1000, this, &ADS1231Calibration::countdown);
+            break;
+
+        case PHASE_ZERO:
+        case PHASE_SPAN:
+        case PHASE_TARE:
+            event_ = queue_->call(this, &ADS1231Calibration::sample);
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+void ADS1231Calibration::step() {
+    if (phase_ != PHASE_RESET) {
+        return;
+    }
+    progress();
+
+    // The status only tells whether DOUT was idle, a missing device shows up on the first read
+    adc_.ADS1231_PowerDown();
+    adc_.ADS1231_Reset();
+
+    phase_ = PHASE_REMOVE_MASS;
+    remaining_ = ADS1231_CAL_EMPTY_S;
+    event_ = queue_->call_in(ADS1231_CAL_SETTLE_MS, this, &ADS1231Calibration::countdown);
+}
+
+
+void ADS1231Calibration::countdown() {
+    if (!is_running()) {
+        return;
+    }
+
+    if (remaining_ > 0) {
+        progress();
+        remaining_--;
+        event_ = queue_->call_in(1000, this, &ADS1231Calibration::countdown);
+        return;
+    }
+
+    switch (phase_) {
+        case PHASE_REMOVE_MASS:
+            enter(PHASE_ZERO, ADS1231_CAL_SPAN_SAMPLES);
+            break;
+        case PHASE_PUT_MASS:
+            enter(PHASE_SPAN, ADS1231_CAL_SPAN_SAMPLES);
+            break;
+        case PHASE_REMOVE_MASS_TARE:
+            enter(PHASE_TARE, ADS1231_CAL_TARE_SAMPLES);
+            break;
+        default:
+            break;
+    }
+}
+
+
+void ADS1231Calibration::sample() {
+    if (!is_running()) {
+        return;
+    }
+
+    // One conversion per event; the wait for DRDY sleeps this thread only
+    ADS1231::Vector_count_t conversion;
+    ADS1231::ADS1231_status_t status = adc_.ADS1231_ReadRawData(&conversion, 1);
+
+    // abort() may have come while the read slept; neither the result nor the next step is wanted
+    if (!is_running()) {
+        return;
+    }
+
+    if (status != ADS1231::ADS1231_SUCCESS) {
+        finish(status);
+        return;
+    }
+
+    sum_ += conversion.myRawValue;
+    count_++;
+    remaining_--;
+    progress();
+
+    if (remaining_ > 0) {
+        event_ = queue_->call(this, &ADS1231Calibration::sample);
+        return;
+    }
+
+    // Mean, rounded to the nearest code
+    uint32_t average = (uint32_t)((sum_ + count_ / 2) / count_);
+    switch (phase_) {
+        case PHASE_ZERO:
+            data_->myRawValue_WithoutCalibratedMass = average;
+            enter(PHASE_PUT_MASS, ADS1231_CAL_LOAD_S);
+            break;
+
+        case PHASE_SPAN:
+            data_->myRawValue_WithCalibratedMass = average;
+            enter(PHASE_REMOVE_MASS_TARE, ADS1231_CAL_EMPTY_S);
+            break;
+
+        case PHASE_TARE: {
+            // Same as ADS1231_SetAutoTare(), but a previous tare must not be subtracted from the new one
+            ADS1231::Vector_count_t tare = *data_;
+            tare.myRawValue = average;
+            tare.myRawValue_TareWeight = 0;
+            data_->myRawValue_TareWeight = adc_.ADS1231_CalculateMass(&tare, mass_, scale_).myMass;
+            finish(ADS1231::ADS1231_SUCCESS);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+
+void ADS1231Calibration::finish(ADS1231::ADS1231_status_t status) {
+    event_ = 0;
+    phase_ = (status == ADS1231::ADS1231_SUCCESS) ? PHASE_DONE : PHASE_FAILED;
+    remaining_ = 0;
+    progress();
+
+    if (on_done_) {
+        on_done_(status);
+    }
+}
+
+
+void ADS1231Calibration::progress() {
+    if (on_progress_) {
+        on_progress_(phase_, remaining_);
+    }
+}
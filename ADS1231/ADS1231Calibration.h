@@ -0,0 +1,127 @@
+#ifndef _ADS1231_CALIBRATION_H_
+#define _ADS1231_CALIBRATION_H_
+
+#include "mbed.h"
+#include "ADS1231.h"
+
+#ifndef ADS1231_CAL_SETTLE_MS
+#define ADS1231_CAL_SETTLE_MS 1000      // after reset: 4 conversions @ 10 SPS plus margin
+#endif
+
+#ifndef ADS1231_CAL_EMPTY_S
+#define ADS1231_CAL_EMPTY_S 5           // seconds given to remove the mass
+#endif
+
+#ifndef ADS1231_CAL_LOAD_S
+#define ADS1231_CAL_LOAD_S 10           // seconds given to put the calibration mass
+#endif
+
+#ifndef ADS1231_CAL_SPAN_SAMPLES
+#define ADS1231_CAL_SPAN_SAMPLES 4      // conversions averaged for the zero and span points
+#endif
+
+#ifndef ADS1231_CAL_TARE_SAMPLES
+#define ADS1231_CAL_TARE_SAMPLES 40     // conversions averaged for the tare weight
+#endif
+
+/**
+ * Zero, span and tare calibration of an ADS1231/ADS1232 as an event-driven
+ * state machine.
+ *
+ * Every step is a short event on the given EventQueue: countdowns are one
+ * event per second and every conversion is its own event, so whatever else
+ * shares the queue, and every other thread, keeps running during the
+ * calibration. The result is written into the Vector_count_t passed to the
+ * constructor, the same fields ADS1231_ReadData_WithoutMass(),
+ * ADS1231_ReadData_WithCalibratedMass() and ADS1231_SetAutoTare() fill.
+ *
+ * The callbacks run on the queue's thread.
+ */
+class ADS1231Calibration {
+
+public:
+
+    enum Phase {
+        PHASE_IDLE = 0,
+        PHASE_RESET,            // power-down, reset and settling
+        PHASE_REMOVE_MASS,      // countdown, the scale must be empty
+        PHASE_ZERO,             // sampling the zero point
+        PHASE_PUT_MASS,         // countdown, the calibration mass must be on
+        PHASE_SPAN,             // sampling the span point
+        PHASE_REMOVE_MASS_TARE, // countdown, the scale must be empty again
+        PHASE_TARE,             // sampling the tare weight
+        PHASE_DONE,
+        PHASE_FAILED
+    };
+
+    /**
+     * Create a calibration sequence
+     * @param adc the converter to calibrate
+     * @param queue EventQueue the steps are posted to; its thread does the blocking reads
+     * @param data calibration points and tare weight are written here
+     */
+    ADS1231Calibration(ADS1231 &adc, EventQueue *queue, ADS1231::Vector_count_t *data);
+
+    /**
+     * Progress callback
+     * @param cb called on every phase change and every countdown second / conversion
+     *           with the phase and what is left of it (seconds or conversions)
+     */
+    void attach_progress(Callback<void(Phase, uint16_t)> cb);
+
+    /**
+     * Completion callback
+     * @param cb called once with ADS1231_SUCCESS or the status of the failed read
+     */
+    void attach_done(Callback<void(ADS1231::ADS1231_status_t)> cb);
+
+    /**
+     * Start the sequence; returns immediately
+     * @param mass calibration mass
+     * @param scale unit of the calibration mass
+     * @return false if a calibration is already running
+     */
+    bool start(float mass, ADS1231::ADS1231_scale_t scale);
+
+    /**
+     * Cancel a running sequence; the data is left as it was
+     */
+    void abort();
+
+    /**
+     * Get the current phase
+     * @return phase
+     */
+    Phase get_phase();
+
+    /**
+     * Check whether a calibration is running
+     * @return true between start() and the completion callback
+     */
+    bool is_running();
+
+private:
+
+    void enter(Phase phase, uint16_t remaining);
+    void step();
+    void countdown();
+    void sample();
+    void finish(ADS1231::ADS1231_status_t status);
+    void progress();
+
+    ADS1231 &adc_;
+    EventQueue *queue_;
+    ADS1231::Vector_count_t *data_;
+    Callback<void(Phase, uint16_t)> on_progress_;
+    Callback<void(ADS1231::ADS1231_status_t)> on_done_;
+
+    volatile Phase phase_;
+    uint16_t remaining_;
+    int event_;
+    float mass_;
+    ADS1231::ADS1231_scale_t scale_;
+    uint64_t sum_;
+    uint16_t count_;
+};
+
+#endif
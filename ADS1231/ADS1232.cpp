@@ -0,0 +1,517 @@
+/**
+ * @brief       ADS1232.cpp
+ * @details     24-Bit Analog-to-Digital Converter for Bridge Sensors, two input channels.
+ *              Functions file.
+ *
+ *
+ * @return      NA
+ *
+ * @pre         NaN.
+ * @warning     NaN
+ */
+
+#include "ADS1232.h"
+
+
+ADS1232::ADS1232 ( PinName SCLK, PinName DOUT, PinName SPEED, PinName GAIN0, PinName GAIN1, PinName A0, PinName TEMP, SpiBitstream* transport )
+    : ADS1231               ( SCLK, DOUT, transport )
+    , _SPEED                ( SPEED )
+    , _GAIN0                ( GAIN0 )
+    , _GAIN1                ( GAIN1 )
+    , _A0                   ( A0 )
+    , _TEMP                 ( TEMP )
+    , _ADS1232_SPEED        ( ADS1232_SPEED_10SPS )
+    , _ADS1232_GAIN         ( ADS1232_GAIN_128 )
+    , _ADS1232_CHANNEL      ( ADS1232_CHANNEL_AIN1 )
+    , _SETTLING             ( 0 )
+    , _DISCARDED            ( 0 )
+    , _SCAN_ENTRIES         ( 0 )
+    , _SCAN_POS             ( 0 )
+    , _CAL_PENDING          ( false )
+    , _CAL_PERIOD_MS        ( 0 )
+    , _CAL_LAST_MS          ( 0 )
+    , _CAL_TEMP_DELTA       ( 0 )
+    , _CAL_TEMP_REF         ( 0 )
+    , _CAL_COUNT            ( 0 )
+{
+    // Power-on selection: 10 SPS, gain 128, AIN1
+    _ADS1232_Write ( _SPEED, 0 );
+    _ADS1232_Write ( _GAIN0, 1 );
+    _ADS1232_Write ( _GAIN1, 1 );
+    _ADS1232_Write ( _A0,    0 );
+    _ADS1232_Write ( _TEMP,  0 );
+}
+
+
+
+/**
+ * @brief       ADS1232_SetSpeed   ( ADS1232_speed_t )
+ *
+ * @details     It drives the SPEED pin.
+ *
+ * @param[in]    mySpeed:         ADS1232_SPEED_10SPS or ADS1232_SPEED_80SPS.
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       ADS1231_FAILURE if the SPEED pin has to change and is strapped ( NC ).
+ *
+ *
+ * @pre         The default data-ready timeout follows the speed. One set by ADS1231_SetTimeout
+ *              is kept, only raised to the settling time of the new speed.
+ * @warning     The next ADS1232_SETTLE_DISCARD conversions are dropped.
+ */
+ADS1231::ADS1231_status_t  ADS1232::ADS1232_SetSpeed ( ADS1232_speed_t mySpeed )
+{
+    uint32_t  myOldDefault   =   ( _ADS1232_SPEED == ADS1232_SPEED_80SPS ) ? ADS1232_TIMEOUT_80SPS_MS : ADS1231_TIMEOUT_MS;
+    uint32_t  myNewDefault   =   ( mySpeed == ADS1232_SPEED_80SPS ) ? ADS1232_TIMEOUT_80SPS_MS : ADS1231_TIMEOUT_MS;
+
+
+    if ( mySpeed == _ADS1232_SPEED )
+        return   ADS1231_SUCCESS;
+
+    // A strapped SPEED pin keeps the chip at its rate, the timeout and the settling must not follow
+    if ( !_SPEED.is_connected () )
+        return   ADS1231_FAILURE;
+
+    _ADS1232_Write ( _SPEED, ( mySpeed == ADS1232_SPEED_80SPS ) ? 1 : 0 );
+    if ( ( ADS1231_GetTimeout () == myOldDefault ) || ( ADS1231_GetTimeout () < myNewDefault ) )
+        ADS1231_SetTimeout ( myNewDefault );
+
+    _ADS1232_SPEED   =   mySpeed;
+    _SETTLING        =   ADS1232_SETTLE_DISCARD;
+
+
+
+    return   ADS1231_SUCCESS;
+}
+
+
+
+/**
+ * @brief       ADS1232_SetGain   ( ADS1232_gain_t )
+ *
+ * @details     It drives the GAIN0 and GAIN1 pins.
+ *
+ * @param[in]    myGain:          ADS1232_GAIN_1, _2, _64 or _128.
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       ADS1231_FAILURE if a GAIN pin that has to change is strapped ( NC ).
+ *
+ *
+ * @pre         NaN.
+ * @warning     The next ADS1232_SETTLE_DISCARD conversions are dropped.
+ */
+ADS1231::ADS1231_status_t  ADS1232::ADS1232_SetGain ( ADS1232_gain_t myGain )
+{
+    if ( myGain == _ADS1232_GAIN )
+        return   ADS1231_SUCCESS;
+
+    if ( _ADS1232_Selectable ( _ADS1232_CHANNEL, myGain ) == false )
+        return   ADS1231_FAILURE;
+
+    _ADS1232_Write ( _GAIN0, ( myGain & 0x01 ) );
+    _ADS1232_Write ( _GAIN1, ( myGain & 0x02 ) >> 1 );
+
+    _ADS1232_GAIN    =   myGain;
+    _SETTLING        =   ADS1232_SETTLE_DISCARD;
+
+
+
+    return   ADS1231_SUCCESS;
+}
+
+
+
+/**
+ * @brief       ADS1232_SetChannel   ( ADS1232_channel_t )
+ *
+ * @details     It drives the A0 and TEMP pins.
+ *
+ * @param[in]    myChannel:       ADS1232_CHANNEL_AIN1, ADS1232_CHANNEL_AIN2 or ADS1232_CHANNEL_TEMP.
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       ADS1231_FAILURE if the A0 or TEMP pin that has to change is strapped ( NC ).
+ *
+ *
+ * @pre         Datasheet: the temperature sensor needs A0 = 0 and is meant to be read at gain 1.
+ * @warning     The next ADS1232_SETTLE_DISCARD conversions are dropped.
+ */
+ADS1231::ADS1231_status_t  ADS1232::ADS1232_SetChannel ( ADS1232_channel_t myChannel )
+{
+    if ( myChannel == _ADS1232_CHANNEL )
+        return   ADS1231_SUCCESS;
+
+    if ( _ADS1232_Selectable ( myChannel, _ADS1232_GAIN ) == false )
+        return   ADS1231_FAILURE;
+
+    _ADS1232_Write ( _A0,   ( myChannel == ADS1232_CHANNEL_AIN2 ) ? 1 : 0 );
+    _ADS1232_Write ( _TEMP, ( myChannel == ADS1232_CHANNEL_TEMP ) ? 1 : 0 );
+
+    _ADS1232_CHANNEL =   myChannel;
+    _SETTLING        =   ADS1232_SETTLE_DISCARD;
+
+
+
+    return   ADS1231_SUCCESS;
+}
+
+
+
+/**
+ * @brief       ADS1232_ReadChannel   ( ADS1232_channel_t, ADS1232_gain_t, Vector_count_t*, Vector_stats_t*, uint8_t )
+ *
+ * @details     It selects the channel and gain, drops the settling conversions and reads a burst.
+ *
+ * @param[in]    myChannel:       Input to read.
+ * @param[in]    myGain:          PGA gain for this input.
+ * @param[in]    num_avg:         How many conversions are averaged.
+ *
+ * @param[out]   myNewRawData:    myRawValue: the mean of the burst.
+ * @param[out]   myStats:         Statistics of the burst.
+ *
+ *
+ * @return       Status of ADS1232_ReadChannel.
+ *
+ *
+ * @pre         After a change the ADS1232 holds DRDY/DOUT high while its filter settles
+ *              ( 4 conversion periods ), the wait for the first conversion covers that.
+ * @warning     NaN.
+ */
+ADS1231::ADS1231_status_t  ADS1232::ADS1232_ReadChannel ( ADS1232_channel_t myChannel, ADS1232_gain_t myGain, Vector_count_t* myNewRawData, Vector_stats_t* myStats, uint8_t num_avg )
+{
+    ADS1231_status_t  aux;
+    Vector_count_t    myDiscard;
+    uint8_t           myFlags    =   0;
+
+
+    // A strapped pin cannot follow, never read the old input under the new tag
+    if ( ( ADS1232_SetChannel ( myChannel ) != ADS1231_SUCCESS ) || ( ADS1232_SetGain ( myGain ) != ADS1231_SUCCESS ) )
+        return   ADS1231_FAILURE;
+
+    // The calibration belongs to the bridge setup, never ride it on a TEMP read
+    if ( ( _CAL_PENDING == true ) && ( myChannel != ADS1232_CHANNEL_TEMP ) ) {
+        _CAL_REQUEST     =   true;
+        _CAL_TIME_MS     =   ( _ADS1232_SPEED == ADS1232_SPEED_80SPS ) ? ADS1232_CAL_TIME_80SPS_MS : ADS1232_CAL_TIME_10SPS_MS;
+    }
+
+    // A conversion started before the switch may still come out, drop it
+    if ( _SETTLING > 0 ) {
+        aux  =   ADS1231_ReadRawStats ( &myDiscard, myStats, _SETTLING );
+        if ( aux != ADS1231_SUCCESS )
+            return   aux;
+
+        _DISCARDED  +=   _SETTLING;
+        _SETTLING    =   0;
+        myFlags      =   myStats->myFlags;                                      // Do not lose a calibration mark on the dropped burst
+    }
+
+    aux  =   ADS1231_ReadRawStats ( myNewRawData, myStats, num_avg );
+    myStats->myFlags    |=   myFlags;
+
+    if ( aux == ADS1231_SUCCESS )
+        _ADS1232_Schedule ( myChannel, myStats );
+
+
+
+    return   aux;
+}
+
+
+
+/**
+ * @brief       ADS1232_SetScan   ( const ADS1232_scan_t*, uint8_t )
+ *
+ * @details     It sets the sequence ADS1232_ScanNext steps through.
+ *
+ * @param[in]    myScan:          Entries ( channel, gain, conversions ).
+ * @param[in]    myEntries:       Number of entries, 1 to ADS1232_SCAN_MAX.
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       ADS1231_FAILURE if the sequence does not fit or an entry needs a strapped ( NC ) pin to change.
+ *
+ *
+ * @pre         NaN.
+ * @warning     NaN.
+ */
+ADS1231::ADS1231_status_t  ADS1232::ADS1232_SetScan ( const ADS1232_scan_t* myScan, uint8_t myEntries )
+{
+    uint8_t i    =   0;
+
+
+    if ( ( myEntries == 0 ) || ( myEntries > ADS1232_SCAN_MAX ) )
+        return   ADS1231_FAILURE;
+
+    for ( i = 0; i < myEntries; i++ ) {
+        if ( myScan[i].myNumAvg == 0 )
+            return   ADS1231_FAILURE;
+
+        if ( _ADS1232_Selectable ( myScan[i].myChannel, myScan[i].myGain ) == false )
+            return   ADS1231_FAILURE;
+
+        _SCAN[i]     =   myScan[i];
+    }
+
+    _SCAN_ENTRIES    =   myEntries;
+    _SCAN_POS        =   0;
+
+
+
+    return   ADS1231_SUCCESS;
+}
+
+
+
+/**
+ * @brief       ADS1232_ScanNext   ( ADS1232_scan_result_t* )
+ *
+ * @details     It reads the next entry of the scan sequence and tags the result with its channel.
+ *
+ * @param[in]    NaN.
+ *
+ * @param[out]   myResult:        Channel, gain, mean and statistics of the entry.
+ *
+ *
+ * @return       Status of ADS1232_ScanNext.
+ *
+ *
+ * @pre         A single-entry sequence never switches, so it runs at the full data rate.
+ * @warning     NaN.
+ */
+ADS1231::ADS1231_status_t  ADS1232::ADS1232_ScanNext ( ADS1232_scan_result_t* myResult )
+{
+    ADS1231_status_t        aux;
+    const ADS1232_scan_t*   myEntry;
+
+
+    if ( _SCAN_ENTRIES == 0 )
+        return   ADS1231_FAILURE;
+
+    myEntry              =   &_SCAN[_SCAN_POS];
+    myResult->myChannel  =   myEntry->myChannel;
+    myResult->myGain     =   myEntry->myGain;
+
+    aux  =   ADS1232_ReadChannel ( myEntry->myChannel, myEntry->myGain, &myResult->myCount, &myResult->myStats, myEntry->myNumAvg );
+
+    // On failure the entry is retried next time
+    if ( aux == ADS1231_SUCCESS )
+        _SCAN_POS    =   ( _SCAN_POS + 1 ) % _SCAN_ENTRIES;
+
+
+
+    return   aux;
+}
+
+
+
+/**
+ * @brief       ADS1232_GetDiscardedCount   ( void )
+ *
+ * @details     It gets how many conversions were dropped for settling since power-up.
+ *
+ * @param[in]    NaN.
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       Number of discarded conversions.
+ *
+ *
+ * @pre         NaN.
+ * @warning     NaN.
+ */
+uint32_t  ADS1232::ADS1232_GetDiscardedCount ( void )
+{
+    return   _DISCARDED;
+}
+
+
+
+/**
+ * @brief       ADS1232_CalibrateOffset   ( void )
+ *
+ * @details     It requests an offset self-calibration.
+ *
+ * @param[in]    NaN.
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       NaN.
+ *
+ *
+ * @pre         The 26th SCLK is appended to the last conversion of the next AIN1/AIN2 read, so
+ *              the only cost is t_CAL ( 801ms @ 10SPS, 101ms @ 80SPS ) before the following data.
+ *              The first burst after it is flagged ADS1231_STATS_OFFSET_CAL.
+ * @warning     It calibrates the gain in use at that moment.
+ */
+void  ADS1232::ADS1232_CalibrateOffset ( void )
+{
+    _CAL_PENDING     =   true;
+}
+
+
+
+/**
+ * @brief       ADS1232_SetCalibrationSchedule   ( uint32_t, uint32_t )
+ *
+ * @details     It sets when offset self-calibrations are requested automatically.
+ *
+ * @param[in]    myPeriod_ms:     Period between calibrations, 0 disables.
+ * @param[in]    myTempDelta:     Change of the ADS1232_CHANNEL_TEMP mean ( ADC codes ) since the last
+ *                                calibration that triggers a new one, 0 disables. It needs a TEMP entry in the scan.
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       NaN.
+ *
+ *
+ * @pre         NaN.
+ * @warning     NaN.
+ */
+void  ADS1232::ADS1232_SetCalibrationSchedule ( uint32_t myPeriod_ms, uint32_t myTempDelta )
+{
+    _CAL_PERIOD_MS   =   myPeriod_ms;
+    _CAL_TEMP_DELTA  =   myTempDelta;
+    _CAL_LAST_MS     =   Kernel::get_ms_count ();
+}
+
+
+
+/**
+ * @brief       ADS1232_GetCalibrationCount   ( void )
+ *
+ * @details     It gets how many offset self-calibrations were run since power-up.
+ *
+ * @param[in]    NaN.
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       Number of offset self-calibrations.
+ *
+ *
+ * @pre         NaN.
+ * @warning     NaN.
+ */
+uint32_t  ADS1232::ADS1232_GetCalibrationCount ( void )
+{
+    return   _CAL_COUNT;
+}
+
+
+
+/**
+ * @brief       _ADS1232_Schedule   ( ADS1232_channel_t, Vector_stats_t* )
+ *
+ * @details     It books the calibration that just ran and requests the next one when it is due.
+ *
+ * @param[in]    myChannel:       Channel of the burst just read.
+ * @param[in]    myStats:         Statistics of the burst just read.
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       NaN.
+ *
+ *
+ * @pre         NaN.
+ * @warning     NaN.
+ */
+void  ADS1232::_ADS1232_Schedule ( ADS1232_channel_t myChannel, Vector_stats_t* myStats )
+{
+    uint64_t  myNow  =   Kernel::get_ms_count ();
+    uint32_t  myDelta;
+
+
+    // ADS1231_ReadRawStats clears the request once the 26th SCLK is out
+    if ( ( _CAL_PENDING == true ) && ( myChannel != ADS1232_CHANNEL_TEMP ) && ( _CAL_REQUEST == false ) ) {
+        _CAL_PENDING     =   false;
+        _CAL_LAST_MS     =   myNow;
+        _CAL_TEMP_REF    =   0;                                                 // Taken again at the next TEMP read
+        _CAL_COUNT++;
+    }
+
+    if ( ( _CAL_PERIOD_MS > 0 ) && ( ( myNow - _CAL_LAST_MS ) >= _CAL_PERIOD_MS ) )
+        _CAL_PENDING     =   true;
+
+    if ( ( myChannel == ADS1232_CHANNEL_TEMP ) && ( _CAL_TEMP_DELTA > 0 ) ) {
+        if ( _CAL_TEMP_REF == 0 ) {
+            _CAL_TEMP_REF    =   myStats->myMean;
+        } else {
+            myDelta  =   ( myStats->myMean > _CAL_TEMP_REF ) ? ( myStats->myMean - _CAL_TEMP_REF ) : ( _CAL_TEMP_REF - myStats->myMean );
+            if ( myDelta >= _CAL_TEMP_DELTA )
+                _CAL_PENDING     =   true;
+        }
+    }
+}
+
+
+
+/**
+ * @brief       _ADS1232_Write   ( DigitalOut&, int )
+ *
+ * @details     It drives a selection pin unless it is strapped ( NC ).
+ *
+ * @param[in]    myPin:           Pin to drive.
+ * @param[in]    myValue:         0 or 1.
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       NaN.
+ *
+ *
+ * @pre         NaN.
+ * @warning     NaN.
+ */
+void  ADS1232::_ADS1232_Write ( DigitalOut& myPin, int myValue )
+{
+    if ( myPin.is_connected () )
+        myPin.write ( myValue );
+}
+
+
+
+/**
+ * @brief       _ADS1232_Selectable   ( ADS1232_channel_t, ADS1232_gain_t )
+ *
+ * @details     It checks that every pin the selection changes is connected.
+ *
+ * @param[in]    myChannel:       Channel to select.
+ * @param[in]    myGain:          Gain to select.
+ *
+ * @param[out]   NaN.
+ *
+ *
+ * @return       false if a strapped ( NC ) pin would have to change.
+ *
+ *
+ * @pre         A strapped pin never changes, so it keeps the level of the current selection.
+ * @warning     NaN.
+ */
+bool  ADS1232::_ADS1232_Selectable ( ADS1232_channel_t myChannel, ADS1232_gain_t myGain )
+{
+    uint8_t  myGainBits  =   myGain ^ _ADS1232_GAIN;
+
+
+    if ( ( myGainBits & 0x01 ) && !_GAIN0.is_connected () )
+        return   false;
+    if ( ( myGainBits & 0x02 ) && !_GAIN1.is_connected () )
+        return   false;
+    if ( ( ( myChannel == ADS1232_CHANNEL_AIN2 ) != ( _ADS1232_CHANNEL == ADS1232_CHANNEL_AIN2 ) ) && !_A0.is_connected () )
+        return   false;
+    if ( ( ( myChannel == ADS1232_CHANNEL_TEMP ) != ( _ADS1232_CHANNEL == ADS1232_CHANNEL_TEMP ) ) && !_TEMP.is_connected () )
+        return   false;
+
+
+
+    return   true;
+}
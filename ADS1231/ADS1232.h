@@ -0,0 +1,201 @@
+/**
+ * @brief       ADS1232.h
+ * @details     24-Bit Analog-to-Digital Converter for Bridge Sensors, two input channels.
+ *              Header file.
+ *
+ *              Same serial interface as the ADS1231, plus the pins that the ADS1231
+ *              has not: SPEED, GAIN0/GAIN1, A0 and TEMP. Any of them may be NC when it
+ *              is strapped on the board.
+ *
+ *
+ * @return      NA
+ *
+ * @pre         NaN.
+ * @warning     NaN
+ */
+#ifndef ADS1232_H
+#define ADS1232_H
+
+#include "mbed.h"
+#include "ADS1231.h"
+
+
+/**
+    Example:
+
+#include "mbed.h"
+#include "ADS1232.h"
+
+ADS1232  myScale ( p5, p6, p7, p8, p9, p10, p11 );   // SCLK, DOUT, SPEED, GAIN0, GAIN1, A0, TEMP
+
+ADS1232::ADS1232_scan_t         myScan[2] = {
+    { ADS1232::ADS1232_CHANNEL_AIN1, ADS1232::ADS1232_GAIN_128, 4 },
+    { ADS1232::ADS1232_CHANNEL_AIN2, ADS1232::ADS1232_GAIN_128, 4 }
+};
+ADS1232::ADS1232_scan_result_t  myResult;
+
+
+int main()
+{
+    myScale.ADS1231_Reset         ();
+    myScale.ADS1232_SetSpeed      ( ADS1232::ADS1232_SPEED_80SPS );
+    myScale.ADS1232_SetScan       ( myScan, 2 );
+
+    while(1)
+    {
+        if ( myScale.ADS1232_ScanNext ( &myResult ) == ADS1231::ADS1231_SUCCESS )
+            printf ( "AIN%d: %lu\r\n", myResult.myChannel + 1, myResult.myStats.myMean );
+    }
+}
+
+*/
+
+
+#ifndef ADS1232_SETTLE_DISCARD
+#define ADS1232_SETTLE_DISCARD     1                  /*!<   Conversions dropped after a SPEED/GAIN/A0/TEMP change            */
+#endif
+
+#define ADS1232_TIMEOUT_80SPS_MS   100                /*!<   Data-ready timeout at 80 SPS: settling 4 * 12.5ms + margin       */
+#define ADS1232_SCAN_MAX           4                  /*!<   Entries of the scan sequence                                     */
+#define ADS1232_CAL_TIME_10SPS_MS  801                /*!<   Offset calibration time at 10 SPS ( datasheet t_CAL )            */
+#define ADS1232_CAL_TIME_80SPS_MS  101                /*!<   Offset calibration time at 80 SPS ( datasheet t_CAL )            */
+
+
+/*!
+ Library for the ADS1232 24-Bit Analog-to-Digital Converter for Bridge Sensors.
+*/
+class ADS1232 : public ADS1231
+{
+public:
+    /**
+      * @brief   SPEED pin
+      */
+    typedef enum {
+        ADS1232_SPEED_10SPS       =   0,              /*!<  SPEED low:  10 SPS, 50/60Hz rejection                                */
+        ADS1232_SPEED_80SPS       =   1               /*!<  SPEED high: 80 SPS                                                   */
+    } ADS1232_speed_t;
+
+
+    /**
+      * @brief   GAIN1:GAIN0 pins
+      */
+    typedef enum {
+        ADS1232_GAIN_1            =   0,              /*!<  GAIN1 = 0, GAIN0 = 0                                                 */
+        ADS1232_GAIN_2            =   1,              /*!<  GAIN1 = 0, GAIN0 = 1                                                 */
+        ADS1232_GAIN_64           =   2,              /*!<  GAIN1 = 1, GAIN0 = 0                                                 */
+        ADS1232_GAIN_128          =   3               /*!<  GAIN1 = 1, GAIN0 = 1                                                 */
+    } ADS1232_gain_t;
+
+
+    /**
+      * @brief   A0 / TEMP pins
+      */
+    typedef enum {
+        ADS1232_CHANNEL_AIN1      =   0,              /*!<  A0 = 0, TEMP = 0                                                     */
+        ADS1232_CHANNEL_AIN2      =   1,              /*!<  A0 = 1, TEMP = 0                                                     */
+        ADS1232_CHANNEL_TEMP      =   2               /*!<  A0 = 0, TEMP = 1 ( use ADS1232_GAIN_1 )                              */
+    } ADS1232_channel_t;
+
+
+    /**
+      * @brief   SCAN SEQUENCE
+      */
+    typedef struct {
+        ADS1232_channel_t  myChannel;
+        ADS1232_gain_t     myGain;
+        uint8_t            myNumAvg;                  /*!<  Conversions averaged for this entry                                  */
+    } ADS1232_scan_t;
+
+    typedef struct {
+        ADS1232_channel_t  myChannel;                 /*!<  Channel the conversions belong to                                    */
+        ADS1232_gain_t     myGain;
+        Vector_count_t     myCount;
+        Vector_stats_t     myStats;
+    } ADS1232_scan_result_t;
+
+
+
+
+    /** Create an ADS1232 object connected to the specified pins.
+     *
+     * @param SCLK  SCLK pin.
+     * @param DOUT  DRDY/DOUT pin.
+     * @param SPEED SPEED pin ( NC: strapped ).
+     * @param GAIN0 GAIN0 pin ( NC: strapped ).
+     * @param GAIN1 GAIN1 pin ( NC: strapped ).
+     * @param A0    A0 pin ( NC: strapped ).
+     * @param TEMP  TEMP pin ( NC: strapped ).
+     * @param transport Optional SPI bit-stream transport ( SCLK on MOSI, DOUT on MISO ).
+     */
+    ADS1232 ( PinName SCLK, PinName DOUT, PinName SPEED = NC, PinName GAIN0 = NC, PinName GAIN1 = NC, PinName A0 = NC, PinName TEMP = NC, SpiBitstream* transport = NULL );
+
+    /** It selects 10 or 80 SPS ( fails if the SPEED pin has to change and is NC ).
+     */
+    ADS1231_status_t  ADS1232_SetSpeed                    ( ADS1232_speed_t mySpeed );
+
+    /** It selects the PGA gain ( fails if a GAIN pin that has to change is NC ).
+     */
+    ADS1231_status_t  ADS1232_SetGain                     ( ADS1232_gain_t myGain );
+
+    /** It selects the input channel or the temperature sensor ( fails if A0/TEMP has to change and is NC ).
+     */
+    ADS1231_status_t  ADS1232_SetChannel                  ( ADS1232_channel_t myChannel );
+
+    /** It reads a burst from a channel, switching and settling first if needed.
+     */
+    ADS1231_status_t  ADS1232_ReadChannel                 ( ADS1232_channel_t myChannel, ADS1232_gain_t myGain, Vector_count_t* myNewRawData, Vector_stats_t* myStats, uint8_t num_avg );
+
+    /** It sets the scan sequence ( up to ADS1232_SCAN_MAX entries ).
+     */
+    ADS1231_status_t  ADS1232_SetScan                     ( const ADS1232_scan_t* myScan, uint8_t myEntries );
+
+    /** It reads the next entry of the scan sequence.
+     */
+    ADS1231_status_t  ADS1232_ScanNext                    ( ADS1232_scan_result_t* myResult );
+
+    /** It gets the number of conversions dropped for settling.
+     */
+    uint32_t  ADS1232_GetDiscardedCount                   ( void );
+
+    /** It requests an offset self-calibration ( 26th SCLK ) at the end of the next read.
+     */
+    void  ADS1232_CalibrateOffset                         ( void );
+
+    /** It schedules offset self-calibrations every myPeriod_ms and/or when the TEMP code moves by myTempDelta ( 0 disables ).
+     */
+    void  ADS1232_SetCalibrationSchedule                  ( uint32_t myPeriod_ms, uint32_t myTempDelta );
+
+    /** It gets the number of offset self-calibrations run since power-up.
+     */
+    uint32_t  ADS1232_GetCalibrationCount                 ( void );
+
+
+
+
+private:
+    void                    _ADS1232_Write         ( DigitalOut& myPin, int myValue );
+    void                    _ADS1232_Schedule      ( ADS1232_channel_t myChannel, Vector_stats_t* myStats );
+    bool                    _ADS1232_Selectable    ( ADS1232_channel_t myChannel, ADS1232_gain_t myGain );
+
+    DigitalOut              _SPEED;
+    DigitalOut              _GAIN0;
+    DigitalOut              _GAIN1;
+    DigitalOut              _A0;
+    DigitalOut              _TEMP;
+    ADS1232_speed_t         _ADS1232_SPEED;
+    ADS1232_gain_t          _ADS1232_GAIN;
+    ADS1232_channel_t       _ADS1232_CHANNEL;
+    uint8_t                 _SETTLING;                                          // Conversions still to drop
+    uint32_t                _DISCARDED;
+    ADS1232_scan_t          _SCAN[ADS1232_SCAN_MAX];
+    uint8_t                 _SCAN_ENTRIES;
+    uint8_t                 _SCAN_POS;
+    bool                    _CAL_PENDING;                                       // Requested, waiting for a bridge-channel read
+    uint32_t                _CAL_PERIOD_MS;
+    uint64_t                _CAL_LAST_MS;
+    uint32_t                _CAL_TEMP_DELTA;
+    uint32_t                _CAL_TEMP_REF;                                      // TEMP code at the last calibration, 0: none yet
+    uint32_t                _CAL_COUNT;
+};
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef _FAST_HX711_H_
+#define _FAST_HX711_H_
+
+#include "mbed.h"
+#include "Hx711.h"
+
+/**
+ * Pin-specialized variant of Hx711 for STM32 targets.
+ * The clock and data pins are template parameters, so their GPIO port and bit
+ * masks are resolved at compile time and the 24-bit shift loop is fully
+ * inlined into direct BSRR/IDR register accesses. DigitalOut/DigitalIn are
+ * kept only to enable the port clock and configure the pins.
+ * The public API follows Hx711's blocking API; the interrupt-driven sampling
+ * and the SPI transport stay with Hx711.
+ *
+ * Example:
+ *      FastHx711<P_8, P_9> loadcell(offset, scale, 64);
+ */
+template <PinName SckPin, PinName DtPin>
+class FastHx711 {
+
+public:
+
+    /**
+     * Create a pin-specialized Hx711 ADC object
+     * @param offset offset for sensor values
+     * @param scale scale factor to obtain real values
+     * @param gain channel selection is made by passing the appropriate gain: 
+     *      128 or 64 for channel A, 32 for channel B
+     */
+    FastHx711(int offset = 0, float scale = 1.0f, uint8_t gain = 128) :
+        sck_(SckPin),
+        dt_(DtPin),
+        corrupted_(0) {
+        set_offset(offset);
+        set_scale(scale);
+        set_gain(gain);
+    }
+
+    /**
+     * Check if the sensor is ready
+     * @return true if the data pin is LOW
+     */
+    MBED_FORCEINLINE bool is_ready() {
+        return (gpio(DT_BASE)->IDR & DT_MASK) == 0;
+    }
+
+    /**
+     * Waits for the chip to be ready and returns a raw int reading;
+     * a corrupted frame is read again, up to HX711_READ_RETRIES times
+     * @return int sensor output value
+     */
+    uint32_t readRaw() {
+        uint32_t bits = 0;
+
+        for (int attempt = 0; attempt <= HX711_READ_RETRIES; attempt++) {
+            while (!is_ready());
+
+            // pulse the clock pin 24 times to read the data
+            bits = 0;
+            for (uint8_t i = 0; i < 24; i++) {
+                bits = (bits << 1) | pulse();
+            }
+
+            // set the channel and the gain factor for the next reading using the clock pin
+            for (uint8_t i = 0; i < gain_; i++) {
+                pulse();
+            }
+
+            // the last pulse pulls DOUT back high; a low DOUT means the chip
+            // lost the frame, e.g. it powered down while the clock was held high
+            if (!is_ready()) {
+                break;
+            }
+            corrupted_++;
+        }
+
+        return Hx711::decode(bits);
+    }
+
+    /**
+     * Obtain offset and scaled sensor output; i.e. a real value
+     * @return float
+     */
+    float read() {
+        return convert_to_real(readRaw());
+    }
+
+    /**
+     * Convert integer value from chip to offset and scaled real value
+     * @param val integer value
+     * @return (val - get_offset()) * get_scale()
+     */
+    float convert_to_real(int val) {
+        return ((float)(val - get_offset())) * get_scale();
+    }
+
+    /**
+     * Puts the chip into power down mode
+     */
+    void power_down() {
+        sck_low();
+        sck_high();
+    }
+
+    /**
+     * Wakes up the chip after power down mode
+     */
+    void power_up() {
+        sck_low();
+    }
+
+    /**
+     * Set the gain factor; takes effect only after a call to read()
+     * @param gain 128, 64 or 32
+     */
+    void set_gain(uint8_t gain = 128) {
+        switch (gain) {
+            case 128:       // channel A, gain factor 128
+                gain_ = 1;
+                break;
+            case 64:        // channel A, gain factor 64
+                gain_ = 3;
+                break;
+            case 32:        // channel B, gain factor 32
+                gain_ = 2;
+                break;
+        }
+
+        sck_low();
+        read();
+    }
+
+    /**
+     * Obtain current gain
+     * @return gain_
+     */
+    uint8_t get_gain() {
+        return gain_;
+    }
+
+    /**
+     * Set the scale factor
+     * @param scale desired scale
+     */
+    void set_scale(float scale = 1.0f) {
+        scale_ = scale;
+    }
+
+    /**
+     * Get sensor scale factor
+     * @return scale_
+     */
+    float get_scale() {
+        return scale_;
+    }
+
+    /**
+     * Set the sensor offset
+     * @param offset the desired offset
+     */
+    void set_offset(int offset = 0) {
+        offset_ = offset;
+    }
+
+    /**
+     * Get current sensor offset
+     * @return offset_
+     */
+    int get_offset() { return offset_; }
+
+    /**
+     * Number of corrupted frames; retried by readRaw()
+     * @return corrupted_
+     */
+    uint32_t get_corrupted_count() {
+        return corrupted_;
+    }
+
+private:
+
+    /**
+     * GPIO port base address of a pin
+     */
+    static constexpr uint32_t port_base(PinName pin) {
+        return (STM_PORT(pin) <= 4) ? GPIOA_BASE + STM_PORT(pin) * (GPIOB_BASE - GPIOA_BASE)
+#ifdef GPIOF_BASE
+             : (STM_PORT(pin) == 5) ? GPIOF_BASE
+#endif
+#ifdef GPIOG_BASE
+             : (STM_PORT(pin) == 6) ? GPIOG_BASE
+#endif
+             : GPIOH_BASE;
+    }
+
+    static constexpr uint32_t SCK_BASE = port_base(SckPin);
+    static constexpr uint32_t SCK_SET  = 1UL << STM_PIN(SckPin);           // BSRR set half
+    static constexpr uint32_t SCK_RST  = 1UL << (STM_PIN(SckPin) + 16);    // BSRR reset half
+    static constexpr uint32_t DT_BASE  = port_base(DtPin);
+    static constexpr uint32_t DT_MASK  = 1UL << STM_PIN(DtPin);
+
+    static MBED_FORCEINLINE GPIO_TypeDef *gpio(uint32_t base) {
+        return reinterpret_cast<GPIO_TypeDef *>(base);
+    }
+
+    static MBED_FORCEINLINE void sck_high() {
+        gpio(SCK_BASE)->BSRR = SCK_SET;
+    }
+
+    static MBED_FORCEINLINE void sck_low() {
+        gpio(SCK_BASE)->BSRR = SCK_RST;
+    }
+
+    /**
+     * One clock pulse with its high phase protected from preemption, as
+     * Hx711::pulse(): PD_SCK high past 60 us powers the chip down
+     * @return data bit read while the clock is high
+     */
+    static MBED_FORCEINLINE uint32_t pulse() {
+        core_util_critical_section_enter();
+        sck_high();
+        uint32_t bit = (gpio(DT_BASE)->IDR & DT_MASK) ? 1 : 0;
+        sck_low();
+        core_util_critical_section_exit();
+        return bit;
+    }
+
+    DigitalOut sck_;    // clock line, pin setup only
+    DigitalIn dt_;      // data line, pin setup only
+
+    uint8_t gain_;      // amplification factor at chip
+    int offset_;        // offset chip value
+    float scale_;       // scale output after offset
+
+    volatile uint32_t corrupted_;   // corrupted frames
+};
+
+#endif
@@ -14,36 +14,143 @@ void Hx711::set_gain(uint8_t gain) {
             break;
     }
 
+    release_transport();
     sck_.write(LOW);
     read();
 }
 
 uint32_t Hx711::readRaw() {
-    // wait for the chip to become ready
-    // TODO: this is not ideal; the programm will hang if the chip never
-    // becomes ready...
-    while (!is_ready());
-
     uint32_t value = 0;
-    uint8_t data[3] = { 0 };
-    uint8_t filler = 0x00;
 
-    // pulse the clock pin 24 times to read the data
-    data[2] = shiftInMsbFirst();
-    data[1] = shiftInMsbFirst();
-    data[0] = shiftInMsbFirst();
+    for (int attempt = 0; attempt <= HX711_READ_RETRIES; attempt++) {
+        // wait for the chip to become ready
+        // TODO: this is not ideal; the programm will hang if the chip never
+        // becomes ready...
+        while (!is_ready());
+
+        value = readConversion();
+        if (frame_ok_) {
+            break;
+        }
+    }
+    return value;
+}
+
+
+uint32_t Hx711::readConversion() {
+    uint32_t bits;
+
+    // the conversion being read was programmed by the previous read
+    last_gain_ = pulses_to_gain(pending_ ? pending_ : gain_);
+    last_settled_ = (settle_ == 0);
+    if (settle_) {
+        settle_--;
+    }
+
+    uint8_t pulses = next_pulses();
+
+    // the SPI driver locks a mutex, which must not happen in an interrupt
+    // handler or a critical section; the frame is bit-banged there instead
+    if (transport_ && !core_util_is_isr_active() && !core_util_in_critical_section()) {
+        // 24 data pulses and the gain pulses in a single SPI burst
+        bits = transport_->read(24 + pulses, 24);
+    } else {
+        // pulse the clock pin 24 times to read the data
+        release_transport();
+        bits  = static_cast<uint32_t>(shiftInMsbFirst()) << 16;
+        bits |= static_cast<uint32_t>(shiftInMsbFirst()) << 8;
+        bits |= static_cast<uint32_t>(shiftInMsbFirst());
+
+        // set the channel and the gain factor for the next reading using the clock pin
+        for (unsigned int i = 0; i < pulses; i++) {
+            pulse();
+        }
+    }
+
+    // the last pulse pulls DOUT back high; a low DOUT means the chip lost
+    // the frame, e.g. it powered down while the clock was held high
+    frame_ok_ = (dt_.read() == HIGH);
+    if (!frame_ok_) {
+        corrupted_++;
+    }
+
+    // the next conversion is the first one after a switch
+    if (pending_ && (pulses != pending_)) {
+        settle_ = scan_ ? scan_discard_ : 0;
+    }
+    pending_ = pulses;
+
+    return decode(bits);
+}
+
+
+bool Hx711::set_rate(uint8_t sps) {
+    if (!rate_.is_connected()) {
+        return false;
+    }
+
+    // RATE high: 80 SPS, low: 10 SPS
+    rate_.write((sps == 80) ? HIGH : LOW);
+    return true;
+}
+
+
+void Hx711::set_decimation(uint16_t factor) {
+    // the accumulators are updated by the readout on the event queue thread
+    lock_.lock();
+
+    decimation_ = factor ? factor : 1;
+    for (int i = 0; i < 2; i++) {
+        ring_[i].sum = 0;
+        ring_[i].count = 0;
+    }
+
+    lock_.unlock();
+}
+
+
+uint8_t Hx711::next_pulses() {
+    if (!scan_) {
+        return gain_;
+    }
 
-    // set the channel and the gain factor for the next reading using the clock pin
-    for (unsigned int i = 0; i < gain_; i++) {
-        sck_.write(HIGH);
-        sck_.write(LOW);
+    if (++scan_pos_ >= scan_count_[scan_channel_]) {
+        scan_pos_ = 0;
+        scan_channel_ ^= 1;
     }
+    return (scan_channel_ == CHANNEL_A) ? scan_pulses_a_ : 2;
+}
+
+
+void Hx711::set_scan(uint8_t gain_a, uint8_t count_a, uint8_t count_b, uint8_t discard) {
+    // the schedule is updated by the readout on the event queue thread
+    lock_.lock();
+
+    scan_pulses_a_ = (gain_a == 64) ? 3 : 1;
+    scan_count_[CHANNEL_A] = count_a + discard;
+    scan_count_[CHANNEL_B] = count_b + discard;
+    scan_discard_ = discard;
+    scan_channel_ = CHANNEL_A;
+    scan_pos_ = 0;
+    scan_ = (count_a > 0) && (count_b > 0);
+
+    // channel A from the next read on
+    gain_ = scan_pulses_a_;
+
+    lock_.unlock();
+}
+
+
+uint32_t Hx711::decode(uint32_t bits) {
+    uint32_t value = 0;
+    uint8_t data[3] = { 0 };
+    uint8_t filler = 0x00;
 
     // Datasheet indicates the value is returned as a two's complement value
     // Flip all the bits
-    data[2] = ~data[2];
-    data[1] = ~data[1];
-    data[0] = ~data[0];
+    data[2] = ~(bits >> 16);
+    data[1] = ~(bits >> 8);
+    data[0] = ~bits;
 
     // Replicate the most significant bit to pad out a 32-bit signed integer
     if ( data[2] & 0x80 ) {
@@ -65,13 +172,115 @@ uint32_t Hx711::readRaw() {
 }
 
 
+void Hx711::start_sampling(EventQueue *queue) {
+    release_transport();
+    sck_.write(LOW);
+    queue_ = queue;
+    sampling_ = true;
+    dt_.fall(callback(this, &Hx711::on_data_ready));
+
+    // a conversion may already be waiting; its edge has been missed
+    if (is_ready()) {
+        core_util_critical_section_enter();
+        on_data_ready();
+        core_util_critical_section_exit();
+    }
+}
+
+
+void Hx711::stop_sampling() {
+    dt_.fall(NULL);
+    sampling_ = false;
+}
+
+
+bool Hx711::pop_sample(Sample *sample, Channel channel) {
+    return ring_[channel].samples.pop(sample);
+}
+
+
+void Hx711::on_data_ready() {
+    // DOUT also toggles while the bits are clocked out, and the pending edges
+    // re-enter here once the frame is done; DOUT is high again by then
+    if (!sampling_ || !is_ready()) {
+        return;
+    }
+
+    // no more edges until the frame is read out; the clock pulses toggle DOUT
+    dt_.disable_irq();
+    if (!queue_->call(this, &Hx711::read_sample, us_ticker_read())) {
+        dt_.enable_irq();   // queue full, the conversion is lost
+    }
+}
+
+
+void Hx711::read_sample(uint32_t timestamp) {
+    lock_.lock();
+
+    // a duplicate post, or stop_sampling() since the edge
+    if (sampling_ && is_ready()) {
+        int32_t raw = static_cast<int32_t>(readConversion());
+
+        // neither corrupted frames nor unsettled conversions after a channel
+        // switch are published
+        if (frame_ok_ && last_settled_) {
+            publish(raw, timestamp);
+        }
+    }
+
+    lock_.unlock();
+    dt_.enable_irq();
+}
+
+
+void Hx711::publish(int32_t raw, uint32_t timestamp) {
+    Ring &ring = ring_[(last_gain_ == 32) ? CHANNEL_B : CHANNEL_A];
+
+    // boxcar decimation, 64-bit accumulation
+    ring.sum += raw;
+    if (++ring.count < decimation_) {
+        return;
+    }
+    int64_t sum = ring.sum;
+    uint16_t count = ring.count;
+    ring.sum = 0;
+    ring.count = 0;
+
+    Sample sample;
+    sample.timestamp = timestamp;
+    sample.raw_fine = (sum * (1 << HX711_FRAC_BITS)) / count;
+    sample.raw = (count > 1) ? (sum / count) : raw;
+    sample.gain = last_gain_;
+    ring.samples.push(sample);  // dropped and counted when full
+}
+
+
 uint8_t Hx711::shiftInMsbFirst() {
     uint8_t value = 0;
 
     for (uint8_t i = 0; i < 8; ++i) {
-        sck_.write(HIGH);
-        value |= dt_.read() << (7 - i);
-        sck_.write(LOW);
+        value |= pulse() << (7 - i);
     }
     return value;
 }
+
+
+uint8_t Hx711::pulse() {
+    uint8_t bit;
+
+    // mask interrupts for the high phase only, a radio interrupt or a higher
+    // priority thread landing in it could hold PD_SCK high past 60 us and
+    // power the chip down; the low phases stay preemptible
+    core_util_critical_section_enter();
+    uint32_t start = DWT->CYCCNT;
+    sck_.write(HIGH);
+    bit = dt_.read();
+    sck_.write(LOW);
+    uint32_t masked = DWT->CYCCNT - start;
+    core_util_critical_section_exit();
+
+    if (masked > max_masked_) {
+        max_masked_ = masked;
+    }
+    return bit;
+}
@@ -1,6 +1,19 @@
 #ifndef _HX711_H_
 #define _HX711_H_
 
+#include "SpiBitstream.h"
+#include "spsc_queue.h"
+
+#ifndef HX711_RING_SIZE
+#define HX711_RING_SIZE 32  // conversions buffered by the interrupt-driven acquisition, a power of two
+#endif
+
+#define HX711_FRAC_BITS 8   // fractional bits of the decimated result
+
+#ifndef HX711_READ_RETRIES
+#define HX711_READ_RETRIES 2    // extra conversions readRaw() waits for after a corrupted frame
+#endif
+
 /**
  * Class for communication with the HX711 24-Bit Analog-to-Digital 
  * Converter (ADC) for Weigh Scales by AVIA Semiconductor.
@@ -12,6 +25,24 @@ class Hx711 {
 
 public:
 
+    /**
+     * Input channel of a conversion; each one has its own sample stream
+     */
+    enum Channel {
+        CHANNEL_A = 0,      // gain 128 or 64
+        CHANNEL_B = 1,      // gain 32
+    };
+
+    /**
+     * A conversion captured by the interrupt-driven acquisition
+     */
+    struct Sample {
+        uint32_t timestamp; // us_ticker time at which the conversion was read out
+        int32_t raw;        // raw two's complement code, mean of the decimated conversions
+        int32_t raw_fine;   // the same mean with HX711_FRAC_BITS fractional bits
+        uint8_t gain;       // gain the conversion was taken with: 128, 64 or 32
+    };
+
     /**
      * Create an Hx711 ADC object
      * @param pin_sck PinName of the clock pin (digital output)
@@ -20,10 +51,28 @@ public:
      * @param scale scale factor to obtain real values
      * @param gain channel selection is made by passing the appropriate gain: 
      *      128 or 64 for channel A, 32 for channel B
+     * @param transport optional SPI bit-stream transport wired to the same pins;
+     *      NULL bit-bangs the pins through GPIO. The SPI driver takes a mutex,
+     *      so reads from interrupt context bit-bang whatever the transport
+     * @param pin_rate optional PinName of the RATE pin (digital output)
      */
-    Hx711(PinName pin_sck, PinName pin_dt, int offset, float scale, uint8_t gain = 128) :
+    Hx711(PinName pin_sck, PinName pin_dt, int offset, float scale, uint8_t gain = 128, SpiBitstream *transport = NULL, PinName pin_rate = NC) :
         sck_(pin_sck),
-        dt_(pin_dt) {
+        dt_(pin_dt),
+        rate_(pin_rate),
+        transport_(transport),
+        queue_(NULL),
+        sampling_(false),
+        pending_(0),
+        settle_(0),
+        last_gain_(0),
+        last_settled_(false),
+        scan_(false),
+        decimation_(1),
+        frame_ok_(true),
+        max_masked_(0),
+        corrupted_(0) {
+        enable_cycle_counter();
         set_offset(offset);
         set_scale(scale);
         set_gain(gain);
@@ -35,11 +84,27 @@ public:
      * @param pin_dt PinName of the data pin (digital input)
      * @param gain channel selection is made by passing the appropriate gain: 
      *      128 or 64 for channel A, 32 for channel B
+     * @param transport optional SPI bit-stream transport wired to the same pins
+     * @param pin_rate optional PinName of the RATE pin (digital output)
      * TODO: constructor overloading is not allowed?
      */
-    Hx711(PinName pin_sck, PinName pin_dt, uint8_t gain = 128) :
+    Hx711(PinName pin_sck, PinName pin_dt, uint8_t gain = 128, SpiBitstream *transport = NULL, PinName pin_rate = NC) :
         sck_(pin_sck),
-        dt_(pin_dt) {
+        dt_(pin_dt),
+        rate_(pin_rate),
+        transport_(transport),
+        queue_(NULL),
+        sampling_(false),
+        pending_(0),
+        settle_(0),
+        last_gain_(0),
+        last_settled_(false),
+        scan_(false),
+        decimation_(1),
+        frame_ok_(true),
+        max_masked_(0),
+        corrupted_(0) {
+        enable_cycle_counter();
         set_offset(0);
         set_scale(1.0f);
         set_gain(gain);
@@ -60,10 +125,156 @@ public:
     
     /**
      * Waits for the chip to be ready and returns a raw int reading
+     * Blocking compatibility path; do not mix with start_sampling()
      * @return int sensor output value
      */
     uint32_t readRaw();
-    
+
+    /**
+     * Start the interrupt-driven acquisition
+     * Every falling edge of DOUT timestamps the conversion and posts its
+     * readout to the event queue; the queue's thread clocks it out, with only
+     * the clock high phases masked, and pushes it into the sample ring buffer.
+     * DOUT stays masked until then. The CPU is free to sleep between
+     * conversions.
+     * @param queue EventQueue whose thread reads the conversions out; it must
+     *      get to them within a conversion period, 12.5 ms at 80 SPS
+     */
+    void start_sampling(EventQueue *queue);
+
+    /**
+     * Stop the interrupt-driven acquisition; buffered samples are kept
+     */
+    void stop_sampling();
+
+    /**
+     * Check if the interrupt-driven acquisition is running
+     * @return sampling_
+     */
+    bool is_sampling() {
+        return sampling_;
+    }
+
+    /**
+     * Number of samples waiting in the ring buffer of a channel
+     * @param channel CHANNEL_A or CHANNEL_B
+     * @return count of buffered samples
+     */
+    uint16_t available(Channel channel = CHANNEL_A) {
+        return ring_[channel].samples.size();
+    }
+
+    /**
+     * Take the oldest sample out of the ring buffer of a channel
+     * @param sample destination of the sample
+     * @param channel CHANNEL_A or CHANNEL_B
+     * @return false if the buffer is empty
+     */
+    bool pop_sample(Sample *sample, Channel channel = CHANNEL_A);
+
+    /**
+     * Number of conversions dropped because the ring buffer of a channel was full
+     * @param channel CHANNEL_A or CHANNEL_B
+     * @return overrun count
+     */
+    uint32_t get_overrun_count(Channel channel = CHANNEL_A) {
+        return ring_[channel].samples.get_overrun_count();
+    }
+
+    /**
+     * Alternate channel A and channel B without dummy reads
+     * The trailing clock pulses of every read already program the channel of
+     * the next conversion, so the schedule is pipelined one conversion ahead.
+     * The first conversions after each switch are not settled; they are
+     * dropped from the sample streams.
+     * @param gain_a 128 or 64, gain of channel A
+     * @param count_a settled conversions per channel A phase
+     * @param count_b settled conversions per channel B phase; 0 stops the
+     *      scan and keeps channel A
+     * @param discard unsettled conversions after each switch, on top of the
+     *      settled ones
+     */
+    void set_scan(uint8_t gain_a, uint8_t count_a, uint8_t count_b, uint8_t discard = 1);
+
+    /**
+     * Select the output data rate through the RATE pin
+     * @param sps 10 or 80
+     * @return false if no RATE pin is connected
+     */
+    bool set_rate(uint8_t sps);
+
+    /**
+     * Average a number of conversions into each published sample
+     * Boxcar, i.e. first-order CIC, decimation with 64-bit accumulation per
+     * channel; e.g. 80 at 80 SPS publishes one sample per second.
+     * @param factor conversions per published sample, 1 disables
+     */
+    void set_decimation(uint16_t factor);
+
+    /**
+     * Obtain the decimation factor
+     * @return decimation_
+     */
+    uint16_t get_decimation() {
+        return decimation_;
+    }
+
+    /**
+     * Worst-case time interrupts were masked by a clock high phase
+     * Only the high phases are protected, PD_SCK high for more than 60 us
+     * would power the chip down; the low phases stay preemptible.
+     * @return maximum masked time in CPU cycles
+     */
+    uint32_t get_max_masked_cycles() {
+        return max_masked_;
+    }
+
+    /**
+     * Worst-case time interrupts were masked by a clock high phase
+     * @return maximum masked time in microseconds
+     */
+    float get_max_masked_us() {
+        return (float)max_masked_ * 1000000.f / SystemCoreClock;
+    }
+
+    /**
+     * Restart the worst-case masked time measurement
+     */
+    void reset_max_masked() {
+        max_masked_ = 0;
+    }
+
+    /**
+     * Number of corrupted frames; retried by readRaw(), dropped by the sampling
+     * @return corrupted_
+     */
+    uint32_t get_corrupted_count() {
+        return corrupted_;
+    }
+
+    /**
+     * Gain the last read conversion was taken with
+     * @return 128, 64 or 32
+     */
+    uint8_t get_last_gain() {
+        return last_gain_;
+    }
+
+    /**
+     * Check if the last read conversion was settled after a channel switch
+     * @return last_settled_
+     */
+    bool is_last_settled() {
+        return last_settled_;
+    }
+
+    /**
+     * Turn the 24 bits clocked out of the chip into a raw int reading
+     * @param bits data bits, MSB first
+     * @return int sensor output value
+     */
+    static uint32_t decode(uint32_t bits);
+
     /**
      * Obtain offset and scaled sensor output; i.e. a real value
      * @return float
@@ -80,11 +291,21 @@ public:
     float convert_to_real(int val) {
         return ((float)(val - get_offset())) * get_scale();
     }
+
+    /**
+     * Convert a decimated value with fractional bits to an offset and scaled real value
+     * @param fine value with HX711_FRAC_BITS fractional bits
+     * @return (fine / 2^HX711_FRAC_BITS - get_offset()) * get_scale()
+     */
+    float convert_fine_to_real(int32_t fine) {
+        return ((float)(fine - get_offset() * (1 << HX711_FRAC_BITS)) / (1 << HX711_FRAC_BITS)) * get_scale();
+    }
     
     /**
      * Puts the chip into power down mode
      */
     void power_down() {
+        release_transport();
         sck_.write(LOW);
         sck_.write(HIGH);
     }
@@ -93,6 +314,7 @@ public:
      * Wakes up the chip after power down mode
      */
     void power_up() {
+        release_transport();
         sck_.write(LOW);
     }
 
@@ -113,6 +335,23 @@ public:
         return gain_;
     }
 
+    /**
+     * Select how the bits are clocked out
+     * @param transport SPI bit-stream transport wired to the same pins, or NULL for GPIO
+     */
+    void set_transport(SpiBitstream *transport) {
+        release_transport();
+        transport_ = transport;
+    }
+
+    /**
+     * Obtain the current transport
+     * @return transport_, NULL when bit-banging through GPIO
+     */
+    SpiBitstream *get_transport() {
+        return transport_;
+    }
+
     /**
      * Set the scale factor
      * @param scale desired scale
@@ -150,12 +389,108 @@ private:
     static const uint8_t HIGH     = 1; // digital high
 
     DigitalOut sck_;    // clock line
-    DigitalIn dt_;      // data line 
+    InterruptIn dt_;    // data line, also the data-ready interrupt source
+    DigitalOut rate_;   // RATE pin, NC if strapped on the board
+    SpiBitstream *transport_;   // SPI clock generator, NULL for GPIO bit-banging
+    EventQueue *queue_;         // runs the readouts of the interrupt-driven acquisition
+    Mutex lock_;                // readout against set_scan() and set_decimation()
 
     uint8_t gain_;      // amplification factor at chip
     int offset_;        // offset chip value
     float scale_;       // scale output after offset
 
+    /**
+     * Sample stream of one channel
+     */
+    struct Ring {
+        SpscQueue<Sample, HX711_RING_SIZE> samples;  // readout to consumer, overruns counted
+        int64_t sum = 0;                    // decimation accumulator
+        uint16_t count = 0;                 // conversions in the accumulator
+    };
+
+    volatile bool sampling_;                // interrupt-driven acquisition is running
+    Ring ring_[2];                          // one stream per channel
+
+    uint8_t pending_;       // clock pulses that programmed the conversion in progress
+    uint8_t settle_;        // unsettled conversions still to come
+    uint8_t last_gain_;     // gain of the last read conversion
+    bool last_settled_;     // the last read conversion was settled
+
+    bool scan_;             // channel A/B scan is running
+    uint8_t scan_pulses_a_; // clock pulses selecting channel A
+    uint16_t scan_count_[2];    // conversions per phase of each channel, discarded ones included
+    uint8_t scan_discard_;  // unsettled conversions after a switch
+    uint8_t scan_channel_;  // channel of the next programmed conversion
+    uint16_t scan_pos_;     // conversions programmed in the current phase
+
+    uint16_t decimation_;   // conversions per published sample
+
+    bool frame_ok_;                 // the last frame released DOUT as expected
+    volatile uint32_t max_masked_;  // worst-case interrupt-masked high phase [cycles]
+    volatile uint32_t corrupted_;   // corrupted frames
+
+    /**
+     * One clock pulse with its high phase protected from preemption
+     * @return data bit sampled during the high phase
+     */
+    uint8_t pulse();
+
+    /**
+     * Start the DWT cycle counter used to measure the masked time
+     */
+    static void enable_cycle_counter() {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+
+    /**
+     * Clock pulses for the conversion after the one being read
+     * @return 1, 2 or 3
+     */
+    uint8_t next_pulses();
+
+    /**
+     * Gain selected by a number of clock pulses
+     * @param pulses 1, 2 or 3
+     * @return 128, 64 or 32
+     */
+    static uint8_t pulses_to_gain(uint8_t pulses) {
+        return (pulses == 1) ? 128 : (pulses == 3) ? 64 : 32;
+    }
+
+    /**
+     * Clock out a conversion that is known to be ready
+     * @return int sensor output value
+     */
+    uint32_t readConversion();
+
+    /**
+     * Hand the pins back to GPIO before driving the clock line directly
+     */
+    void release_transport() {
+        if (transport_) {
+            transport_->release();
+        }
+    }
+
+    /**
+     * DOUT falling edge handler of the interrupt-driven acquisition
+     */
+    void on_data_ready();
+
+    /**
+     * Clock out and publish a conversion; event queue thread
+     * @param timestamp us_ticker time of the DOUT falling edge
+     */
+    void read_sample(uint32_t timestamp);
+
+    /**
+     * Decimate a settled conversion into the ring buffer of its channel
+     * @param raw conversion code
+     * @param timestamp us_ticker time of the conversion
+     */
+    void publish(int32_t raw, uint32_t timestamp);
+
     /**
      * Port of the Arduino shiftIn function; shifts a byte one bit at a time
      * @return incoming but
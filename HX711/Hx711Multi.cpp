@@ -0,0 +1,112 @@
+#include "mbed.h"
+#include "Hx711.h"
+#include "Hx711Multi.h"
+
+static uint32_t port_mask(const PinName *pins, uint8_t count) {
+    uint32_t mask = 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+        mask |= 1UL << STM_PIN(pins[i]);
+    }
+    return mask;
+}
+
+
+Hx711Multi::Hx711Multi(PinName pin_sck, PortName port, const PinName *pins_dt, uint8_t count, uint8_t gain) :
+    sck_(pin_sck),
+    dt_(port, port_mask(pins_dt, count)),
+    mask_(port_mask(pins_dt, count)),
+    count_(count),
+    corrupted_(0) {
+    MBED_ASSERT(count > 0 && count <= HX711_MULTI_MAX_CHANNELS);
+
+    for (uint8_t i = 0; i < count; i++) {
+        MBED_ASSERT(STM_PORT(pins_dt[i]) == (uint32_t)port);
+        bits_[i] = STM_PIN(pins_dt[i]);
+    }
+    set_gain(gain);
+}
+
+
+void Hx711Multi::set_gain(uint8_t gain) {
+    switch (gain) {
+        case 128:       // channel A, gain factor 128
+            gain_ = 1;
+            break;
+        case 64:        // channel A, gain factor 64
+            gain_ = 3;
+            break;
+        case 32:        // channel B, gain factor 32
+            gain_ = 2;
+            break;
+    }
+
+    int32_t codes[HX711_MULTI_MAX_CHANNELS];
+    sck_.write(LOW);
+    readRaw(codes);
+}
+
+
+void Hx711Multi::readRaw(int32_t *codes) {
+    uint32_t frames[24];
+
+    for (int attempt = 0; attempt <= HX711_READ_RETRIES; attempt++) {
+        // wait for every chip to become ready
+        while (!is_ready());
+
+        if (readFrame(frames)) {
+            break;
+        }
+    }
+
+    transpose(frames, bits_, count_, codes);
+}
+
+
+bool Hx711Multi::readFrame(uint32_t *frames) {
+    // pulse the shared clock pin 24 times, one port read per bit
+    for (uint8_t i = 0; i < 24; i++) {
+        frames[i] = pulse();
+    }
+
+    // set the channel and the gain factor for the next reading using the clock pin
+    for (unsigned int i = 0; i < gain_; i++) {
+        pulse();
+    }
+
+    // the last pulse pulls every DOUT back high; a low DOUT means that chip
+    // lost the frame, e.g. it powered down while the clock was held high
+    if ((dt_.read() & mask_) != mask_) {
+        corrupted_++;
+        return false;
+    }
+    return true;
+}
+
+
+uint32_t Hx711Multi::pulse() {
+    uint32_t port;
+
+    // as Hx711::pulse(): PD_SCK high past 60 us powers every chip down, so
+    // the high phase must not be preempted; the low phases stay preemptible
+    core_util_critical_section_enter();
+    sck_.write(HIGH);
+    port = dt_.read();
+    sck_.write(LOW);
+    core_util_critical_section_exit();
+
+    return port;
+}
+
+
+void Hx711Multi::transpose(const uint32_t *frames, const uint8_t *bits, uint8_t count, int32_t *codes) {
+    for (uint8_t ch = 0; ch < count; ch++) {
+        uint32_t data = 0;
+
+        for (uint8_t i = 0; i < 24; i++) {
+            data = (data << 1) | ((frames[i] >> bits[ch]) & 1);
+        }
+
+        codes[ch] = static_cast<int32_t>(Hx711::decode(data));
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef _HX711_MULTI_H_
+#define _HX711_MULTI_H_
+
+#ifndef HX711_MULTI_MAX_CHANNELS
+#define HX711_MULTI_MAX_CHANNELS 4  // e.g. one HX711 per platform corner
+#endif
+
+/**
+ * Class for synchronous reading of several HX711 sharing one PD_SCK line.
+ * Every DOUT pin must sit on the same GPIO port; each clock edge samples all
+ * channels with a single port-register read and the bits are transposed into
+ * one 24-bit code per channel afterwards.
+ * The codes follow the same convention as Hx711::readRaw().
+ */
+class Hx711Multi {
+
+public:
+
+    /**
+     * Create a multi-channel Hx711 ADC object
+     * @param pin_sck PinName of the shared clock pin (digital output)
+     * @param port PortName of the GPIO port holding every data pin
+     * @param pins_dt PinName of the data pins, one per channel (digital inputs)
+     * @param count number of channels, up to HX711_MULTI_MAX_CHANNELS
+     * @param gain channel selection is made by passing the appropriate gain: 
+     *      128 or 64 for channel A, 32 for channel B
+     */
+    Hx711Multi(PinName pin_sck, PortName port, const PinName *pins_dt, uint8_t count, uint8_t gain = 128);
+
+    /**
+     * Check if every sensor is ready
+     * @return true if all data pins are LOW
+     */
+    bool is_ready() {
+        return (dt_.read() & mask_) == 0;
+    }
+
+    /**
+     * Waits for every chip to be ready and reads one time-aligned frame;
+     * a corrupted frame is read again, up to HX711_READ_RETRIES times
+     * @param codes destination, one raw int reading per channel
+     */
+    void readRaw(int32_t *codes);
+
+    /**
+     * Set the gain factor of every chip; takes effect only after a call to readRaw()
+     * @param gain 128, 64 or 32
+     */
+    void set_gain(uint8_t gain = 128);
+
+    /**
+     * Obtain the number of channels
+     * @return count_
+     */
+    uint8_t get_count() {
+        return count_;
+    }
+
+    /**
+     * Number of corrupted frames, any channel not releasing its DOUT; retried by readRaw()
+     * @return corrupted_
+     */
+    uint32_t get_corrupted_count() {
+        return corrupted_;
+    }
+
+    /**
+     * Transpose port snapshots into per-channel codes
+     * @param frames 24 port snapshots, MSB first, one per clock
+     * @param bits bit position of each channel within the port
+     * @param count number of channels
+     * @param codes destination, one raw int reading per channel
+     */
+    static void transpose(const uint32_t *frames, const uint8_t *bits, uint8_t count, int32_t *codes);
+
+private:
+
+    static const uint8_t LOW      = 0; // digital low
+    static const uint8_t HIGH     = 1; // digital high
+
+    DigitalOut sck_;    // shared clock line
+    PortIn dt_;         // data lines
+
+    uint32_t mask_;                             // port mask of every data pin
+    uint8_t bits_[HX711_MULTI_MAX_CHANNELS];    // bit position of each data pin
+    uint8_t count_;                             // number of channels
+    uint8_t gain_;                              // trailing clock pulses selecting the next gain
+    volatile uint32_t corrupted_;               // corrupted frames
+
+    /**
+     * One clock pulse with its high phase protected from preemption
+     * @return port snapshot while the clock is high
+     */
+    uint32_t pulse();
+
+    /**
+     * Clocks out one frame and the gain pulses
+     * @param frames destination, 24 port snapshots
+     * @return true if every chip released DOUT after the last pulse
+     */
+    bool readFrame(uint32_t *frames);
+};
+
+#endif
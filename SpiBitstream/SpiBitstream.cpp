@@ -0,0 +1,69 @@
+#include "mbed.h"
+#include "SpiBitstream.h"
+
+#include "hal/gpio_api.h"
+#include "hal/pinmap.h"
+#include "PeripheralPins.h"
+
+
+SpiBitstream::SpiBitstream(PinName pin_clk, PinName pin_data, PinName pin_spi_sclk, int hz) :
+    spi_(pin_clk, pin_data, pin_spi_sclk),
+    clk_(pin_clk),
+    data_(pin_data),
+    attached_(true),
+    pulses_(0) {
+    spi_.format(8, 0);  // MOSI changes at the start of a bit, MISO is sampled in its middle
+    spi_.frequency(hz);
+    memset(tx_, 0, sizeof(tx_));
+
+    // The drivers own the lines until the first read
+    release();
+}
+
+
+uint32_t SpiBitstream::read(uint8_t pulses, uint8_t bits) {
+    MBED_ASSERT(pulses <= SPI_BITSTREAM_MAX_PULSES && bits <= pulses && bits <= 24);
+
+    // each pulse is the bit pair "10"; trailing zero bits keep the clock low
+    if (pulses != pulses_) {
+        memset(tx_, 0, sizeof(tx_));
+        for (uint8_t i = 0; i < pulses; i++) {
+            tx_[i >> 2] |= 0x80 >> ((i & 3) << 1);
+        }
+        pulses_ = pulses;
+    }
+
+    if (!attached_) {
+        attach();
+    }
+
+    char rx[FRAME_BYTES];
+    uint8_t len = (2 * pulses + 7) / 8;
+    spi_.write(tx_, len, rx, len);
+
+    // data bit of pulse i is the one sampled while the clock was high
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < bits; i++) {
+        value = (value << 1) | ((rx[i >> 2] >> (7 - ((i & 3) << 1))) & 1);
+    }
+    return value;
+}
+
+
+void SpiBitstream::release() {
+    if (!attached_) {
+        return;
+    }
+
+    gpio_t gpio;
+    gpio_init_out(&gpio, clk_);     // driven low
+    gpio_init_in(&gpio, data_);
+    attached_ = false;
+}
+
+
+void SpiBitstream::attach() {
+    pinmap_pinout(clk_, PinMap_SPI_MOSI);
+    pinmap_pinout(data_, PinMap_SPI_MISO);
+    attached_ = true;
+}
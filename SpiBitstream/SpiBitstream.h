@@ -0,0 +1,65 @@
+#ifndef _SPI_BITSTREAM_H_
+#define _SPI_BITSTREAM_H_
+
+#include "mbed.h"
+
+#ifndef SPI_BITSTREAM_DEFAULT_HZ
+#define SPI_BITSTREAM_DEFAULT_HZ 1000000    // 2 SPI bits per clock pulse -> 500 kHz pulses, 1 us high phase
+#endif
+
+#define SPI_BITSTREAM_MAX_PULSES 28         // longest frame: HX711 24 + 3 gain pulses, ADS1232 24 + 2 calibration pulses
+
+/**
+ * Clocked serial reads (HX711, ADS1231/ADS1232) generated by an SPI peripheral.
+ *
+ * The converter's clock input is wired to MOSI and its data output to MISO.
+ * Every clock pulse is sent as a "10" bit pair on MOSI, so any pulse count can
+ * be produced with 8-bit frames, and DOUT is captured by MISO in the middle of
+ * each high phase. The SPI's own SCLK pin is not used by the converter and may
+ * be NC where the target allows it.
+ *
+ * The pins are handed back to GPIO by release() so that drivers can hold the
+ * clock line (power down, reset); the next read() takes them over again.
+ */
+class SpiBitstream {
+
+public:
+
+    /**
+     * Create an SPI bit-stream transport
+     * @param pin_clk PinName of the converter clock line, an SPI MOSI pin
+     * @param pin_data PinName of the converter data line, an SPI MISO pin
+     * @param pin_spi_sclk PinName of the (unused) SPI clock pin
+     * @param hz SPI bit rate; two bits per converter clock pulse
+     */
+    SpiBitstream(PinName pin_clk, PinName pin_data, PinName pin_spi_sclk = NC, int hz = SPI_BITSTREAM_DEFAULT_HZ);
+
+    /**
+     * Issue clock pulses and capture the data line on the first ones
+     * @param pulses total number of clock pulses, up to SPI_BITSTREAM_MAX_PULSES
+     * @param bits number of leading pulses whose data bit is returned, up to 24
+     * @return the captured bits, MSB first
+     */
+    uint32_t read(uint8_t pulses, uint8_t bits);
+
+    /**
+     * Give the pins back to GPIO, clock line driven low
+     */
+    void release();
+
+private:
+
+    static const uint8_t FRAME_BYTES = (2 * SPI_BITSTREAM_MAX_PULSES + 7) / 8;
+
+    SPI spi_;
+    PinName clk_;
+    PinName data_;
+    bool attached_;                 // pins are routed to the SPI peripheral
+
+    char tx_[FRAME_BYTES];          // cached pulse pattern
+    uint8_t pulses_;                // pulse count of the cached pattern
+
+    void attach();
+};
+
+#endif
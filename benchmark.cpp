@@ -0,0 +1,173 @@
+#include "mbed.h"
+
+#include "benchmark.h"
+#include "ADS1220Decimator.h"
+
+#include "trace_helper.h"
+#define TRACE_GROUP "bench"
+
+
+/******************************************************************************
+ * Cycle counter
+ *
+ * The DWT cycle counter of the Cortex-M3 counts core clocks; the time taken by
+ * a blocking read is also the CPU time it costs.
+ ******************************************************************************/
+void benchmark_init()
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+void benchmark_report(const char *name, uint64_t cycles, uint32_t samples)
+{
+    uint32_t per_sample = cycles / samples;
+    float us = (float)per_sample * 1000000.f / SystemCoreClock;
+
+    tr_info("%s: %lu cycles, %.1fus per sample; CPU load %.3f%% @10SPS, %.3f%% @80SPS\r\n", name,
+        per_sample, us, us * 10 / 10000.f, us * 80 / 10000.f);
+}
+
+
+/******************************************************************************
+ * HX711: GPIO bit-banging vs. SPI bit-stream
+ ******************************************************************************/
+void benchmark_hx711_transport(Hx711 &hx711, SpiBitstream *spi)
+{
+    SpiBitstream *transports[2] = { NULL, spi };
+    SpiBitstream *saved = hx711.get_transport();
+
+    for (int t = 0; t < 2; t++)
+    {
+        if (t > 0 && spi == NULL)
+            break;
+
+        hx711.set_transport(transports[t]);
+        uint64_t cycles = 0;
+
+        for (int i = 0; i < BENCHMARK_SAMPLES; i++)
+        {
+            while (!hx711.is_ready());  // Time the read-out only, not the conversion
+            uint32_t start = benchmark_cycles();
+            hx711.readRaw();
+            cycles += benchmark_cycles() - start;
+        }
+        benchmark_report(t ? "HX711 SPI " : "HX711 GPIO", cycles, BENCHMARK_SAMPLES);
+    }
+
+    hx711.set_transport(saved);
+}
+
+
+/******************************************************************************
+ * ADS1232: GPIO bit-banging vs. SPI bit-stream
+ ******************************************************************************/
+void benchmark_ads1232_transport(ADS1231 &ads1232, SpiBitstream *spi)
+{
+    SpiBitstream *transports[2] = { NULL, spi };
+    ADS1231::Vector_count_t count;
+
+    for (int t = 0; t < 2; t++)
+    {
+        if (t > 0 && spi == NULL)
+            break;
+
+        ads1232.ADS1231_SetTransport(transports[t]);
+        uint64_t cycles = 0;
+
+        for (int i = 0; i < BENCHMARK_SAMPLES; i++)
+        {
+            while (ads1232.ADS1231_GetDataOutputStatus() != ADS1231::ADS1231_DATA_READY);
+            uint32_t start = benchmark_cycles();
+            ads1232.ADS1231_ReadRawData(&count, 1);
+            cycles += benchmark_cycles() - start;
+        }
+        benchmark_report(t ? "ADS1232 SPI " : "ADS1232 GPIO", cycles, BENCHMARK_SAMPLES);
+    }
+
+    ads1232.ADS1231_SetTransport(spi);  // main() passes the transport it reads through
+}
+
+
+/******************************************************************************
+ * ADS1220: RDATA command vs. direct read
+ *
+ * Only the bus cost is timed, the data of a read between two DRDYs is ignored.
+ ******************************************************************************/
+void benchmark_ads1220_read(ADS1220 &ads1220)
+{
+    // Its own configuration: the power-on registers are single-shot, and the
+    // direct read needs continuous conversions
+    ads1220.SendResetCommand();
+    ThisThread::sleep_for(1);
+    ads1220.Config(ADS1220_DR_1000, ADS1220_MODE_NORMAL);
+    ads1220.SendStartCommand();
+
+    for (int direct = 0; direct < 2; direct++)
+    {
+        ads1220.SetDirectRead(direct != 0);
+        ads1220.ResetBusCounters();
+        uint64_t cycles = 0;
+
+        for (int i = 0; i < BENCHMARK_SAMPLES; i++)
+        {
+            ads1220.WaitForDataReady(10);  // Time the read-out only, not the conversion
+            uint32_t start = benchmark_cycles();
+            ads1220.ReadData();
+            cycles += benchmark_cycles() - start;
+        }
+        benchmark_report(direct ? "ADS1220 direct" : "ADS1220 RDATA ", cycles, BENCHMARK_SAMPLES);
+        tr_info("  %lu transactions, %luus SCLK time per sample\r\n",
+            ads1220.GetTransactionCount() / BENCHMARK_SAMPLES, ads1220.GetBusTimeUs() / BENCHMARK_SAMPLES);
+    }
+
+    ads1220.SetDirectRead(false);
+    ads1220.ResetBusCounters();
+    ads1220.SendResetCommand();  // The acquisition configures it from scratch
+}
+
+
+/******************************************************************************
+ * ADS1220: CIC+FIR decimation of the 2 kSPS turbo stream
+ *
+ * One second of synthetic conversions, in stream blocks, through each output
+ * rate. The budget is the core clocks between two conversions at 2 kSPS; the
+ * SPI read and the ISR/queue hop of every conversion come on top.
+ ******************************************************************************/
+static void benchmark_decimator_sink(int32_t value, uint32_t timestamp)
+{
+}
+
+void benchmark_ads1220_decimator()
+{
+    static const uint16_t rates[3] = { 10, 50, 100 };
+    static ADS1220Block block;  // Not on the main stack
+    ADS1220Decimator decimator(1);
+
+    decimator.Attach(benchmark_decimator_sink);
+    for (int r = 0; r < 3; r++)
+    {
+        decimator.SetRatio(2000 / rates[r]);
+        uint64_t cycles = 0;
+
+        for (int b = 0; b < 2000 / ADS1220_BLOCK_SIZE; b++)
+        {
+            for (int i = 0; i < ADS1220_BLOCK_SIZE; i++)
+            {
+                block.Data[i] = (int32_t)((b * ADS1220_BLOCK_SIZE + i) * 2654435761u) >> 8;  // 24 bit noise
+                block.Timestamp[i] = i;
+            }
+            block.Count = ADS1220_BLOCK_SIZE;
+
+            uint32_t start = benchmark_cycles();
+            decimator.Process(&block);
+            cycles += benchmark_cycles() - start;
+        }
+
+        uint32_t per_sample = cycles / 2000;
+        uint32_t budget = SystemCoreClock / 2000;
+        tr_info("ADS1220 CIC+FIR 2000->%uHz: %lu cycles per conversion, %lu budget, CPU load %.2f%%\r\n",
+            rates[r], per_sample, budget, per_sample * 100.f / budget);
+    }
+}
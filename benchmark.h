@@ -0,0 +1,93 @@
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include "Hx711.h"
+#include "FastHx711.h"
+#include "ADS1231.h"
+#include "ADS1220.h"
+
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define BENCHMARK_SAMPLES 20    // Conversions timed per measured path
+
+
+/******************************************************************************
+ * Functions
+ ******************************************************************************/
+void benchmark_init();
+void benchmark_report(const char *name, uint64_t cycles, uint32_t samples);
+void benchmark_hx711_transport(Hx711 &hx711, SpiBitstream *spi);
+void benchmark_ads1232_transport(ADS1231 &ads1232, SpiBitstream *spi);
+void benchmark_ads1220_read(ADS1220 &ads1220);
+void benchmark_ads1220_decimator();
+
+static inline uint32_t benchmark_cycles()
+{
+    return DWT->CYCCNT;
+}
+
+
+/******************************************************************************
+ * HX711: DigitalOut/DigitalIn vs. pin-specialized BSRR/IDR accesses
+ ******************************************************************************/
+template <PinName SckPin, PinName DtPin>
+void benchmark_hx711_fast(Hx711 &hx711, FastHx711<SckPin, DtPin> &fast)
+{
+    uint64_t cycles = 0;
+    SpiBitstream *saved = hx711.get_transport();
+
+    // both readRaw() paths mask every high phase and check the frame; the bare
+    // DigitalOut loop shows what that protection costs
+    {
+        DigitalOut sck(SckPin);
+        DigitalIn dt(DtPin);
+
+        hx711.set_transport(NULL);
+        for (int i = 0; i < BENCHMARK_SAMPLES; i++)
+        {
+            while (dt.read());      // Time the read-out only, not the conversion
+            uint32_t start = benchmark_cycles();
+            uint32_t bits = 0;
+            for (uint8_t b = 0; b < 24; b++)
+            {
+                sck.write(1);
+                bits = (bits << 1) | dt.read();
+                sck.write(0);
+            }
+            for (uint8_t p = 0; p < fast.get_gain(); p++)
+            {
+                sck.write(1);
+                sck.write(0);
+            }
+            Hx711::decode(bits);
+            cycles += benchmark_cycles() - start;
+        }
+        benchmark_report("HX711 DigitalOut, bare     ", cycles, BENCHMARK_SAMPLES);
+    }
+
+    cycles = 0;
+    for (int i = 0; i < BENCHMARK_SAMPLES; i++)
+    {
+        while (!hx711.is_ready());
+        uint32_t start = benchmark_cycles();
+        hx711.readRaw();
+        cycles += benchmark_cycles() - start;
+    }
+    benchmark_report("HX711 DigitalOut, protected", cycles, BENCHMARK_SAMPLES);
+    hx711.set_transport(saved);
+
+    cycles = 0;
+    for (int i = 0; i < BENCHMARK_SAMPLES; i++)
+    {
+        while (!fast.is_ready());
+        uint32_t start = benchmark_cycles();
+        fast.readRaw();
+        cycles += benchmark_cycles() - start;
+    }
+    benchmark_report("HX711 BSRR/IDR, protected  ", cycles, BENCHMARK_SAMPLES);
+}
+
+
+#endif  // __BENCHMARK_H__
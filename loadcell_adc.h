@@ -0,0 +1,157 @@
+#ifndef __LOADCELL_ADC_H__
+#define __LOADCELL_ADC_H__
+
+#include "mbed.h"
+
+
+/******************************************************************************
+ * Definitions
+ *
+ * One acquisition interface for the HX711, ADS1232 and ADS1220 front ends.
+ * A chip adapter derives from LoadCellAdcBase<Adapter> and provides
+ *
+ *     void start_adc(void);                           // configure and start sampling
+ *     LoadCellStatus read_adc(LoadCellReading *r);    // the oldest record not read yet: raw, fine, count, timestamp
+ *     void trace_adc(uint16_t n, LoadCellStatus s);   // optional, chip diagnostics
+ *
+ * and the pipeline is written once against start()/read()/trace(). read()
+ * hands out the converter's records one by one, in time order, until
+ * LOADCELL_NO_DATA; trace() follows once they are drained. Called on
+ * the adapter type the calls are resolved at compile time and inline; for a
+ * runtime choice wrap the adapter in LoadCellAdcVirtual<Adapter> and use it
+ * through LoadCellAdc.
+ ******************************************************************************/
+#define LOADCELL_FRAC_BITS 8    // Fractional bits of LoadCellReading::fine, as HX711_FRAC_BITS
+
+typedef int32_t LoadCellRaw;    // Sign-extended conversion code
+
+typedef enum {
+    LOADCELL_OK = 0,
+    LOADCELL_NO_DATA,           // All records read
+    LOADCELL_CALIBRATING,       // The calibration has not completed yet
+    LOADCELL_DISCARDED,         // Valid conversions, left out (e.g. an offset calibration inside them)
+    LOADCELL_TIMEOUT,           // Conversion late
+    LOADCELL_NOT_FOUND,         // No data-ready since reset
+    LOADCELL_ERROR
+} LoadCellStatus;
+
+// The calibration hook: read() maps every reading through it
+typedef struct {
+    LoadCellRaw offset;         // Code without load
+    float scale;                // Mass per code
+    float volt_per_code;        // Input-referred code size
+} LoadCellCalibration;
+
+typedef struct {
+    LoadCellRaw raw;            // Code of the record, the mean when the converter averages
+    int32_t fine;               // The same with LOADCELL_FRAC_BITS fractional bits
+    uint16_t count;             // Conversions behind the record
+    uint32_t timestamp;         // us_ticker time of the newest of them
+    float volt;
+    float mass;
+} LoadCellReading;
+
+static inline const char *loadcell_status_text(LoadCellStatus status)
+{
+    switch (status)
+    {
+        case LOADCELL_OK:           return "ok";
+        case LOADCELL_NO_DATA:      return "no data";
+        case LOADCELL_CALIBRATING:  return "calibrating";
+        case LOADCELL_DISCARDED:    return "discarded";
+        case LOADCELL_TIMEOUT:      return "conversion late (timeout)";
+        case LOADCELL_NOT_FOUND:    return "not found (no DRDY since reset)";
+        default:                    return "read failed";
+    }
+}
+
+
+/******************************************************************************
+ * Static form, CRTP: no virtual calls, the adapter hooks inline into the pipeline
+ ******************************************************************************/
+template <class Adapter>
+class LoadCellAdcBase
+{
+public:
+    const char *name(void) const { return name_; }
+
+    void start(void) { adapter().start_adc(); }
+
+    LoadCellStatus read(LoadCellReading *reading)
+    {
+        LoadCellStatus status = adapter().read_adc(reading);
+
+        if (status == LOADCELL_OK || status == LOADCELL_DISCARDED)
+        {
+            reading->volt = reading->fine * (calibration_.volt_per_code / (1 << LOADCELL_FRAC_BITS));
+            reading->mass = ((float)(reading->fine - (int64_t)calibration_.offset * (1 << LOADCELL_FRAC_BITS)) / (1 << LOADCELL_FRAC_BITS)) * calibration_.scale;
+        }
+        return status;
+    }
+
+    void trace(uint16_t n, LoadCellStatus status) { adapter().trace_adc(n, status); }
+
+    void set_calibration(const LoadCellCalibration &calibration) { calibration_ = calibration; }
+    const LoadCellCalibration &get_calibration(void) const { return calibration_; }
+
+protected:
+    LoadCellAdcBase(const char *name, const LoadCellCalibration &calibration) :
+        name_(name),
+        calibration_(calibration) {
+    }
+
+    // Default hook, hidden by adapters that have something to add
+    void trace_adc(uint16_t n, LoadCellStatus status) {}
+
+    // Fills fine from raw, for the converters without fractional bits
+    static void set_raw(LoadCellReading *reading, LoadCellRaw raw, uint16_t count, uint32_t timestamp)
+    {
+        reading->raw       = raw;
+        reading->fine      = raw * (1 << LOADCELL_FRAC_BITS);
+        reading->count     = count;
+        reading->timestamp = timestamp;
+    }
+
+private:
+    Adapter &adapter(void) { return *static_cast<Adapter *>(this); }
+
+    const char *name_;
+    LoadCellCalibration calibration_;
+};
+
+
+/******************************************************************************
+ * Runtime form: one virtual call per operation, forwarded to the static form
+ ******************************************************************************/
+class LoadCellAdc
+{
+public:
+    virtual ~LoadCellAdc() {}
+
+    virtual const char *name(void) const = 0;
+    virtual void start(void) = 0;
+    virtual LoadCellStatus read(LoadCellReading *reading) = 0;
+    virtual void trace(uint16_t n, LoadCellStatus status) = 0;
+    virtual void set_calibration(const LoadCellCalibration &calibration) = 0;
+    virtual const LoadCellCalibration &get_calibration(void) const = 0;
+};
+
+template <class Adapter>
+class LoadCellAdcVirtual : public LoadCellAdc
+{
+public:
+    LoadCellAdcVirtual(Adapter &adapter) : adapter_(adapter) {}
+
+    virtual const char *name(void) const { return adapter_.name(); }
+    virtual void start(void) { adapter_.start(); }
+    virtual LoadCellStatus read(LoadCellReading *reading) { return adapter_.read(reading); }
+    virtual void trace(uint16_t n, LoadCellStatus status) { adapter_.trace(n, status); }
+    virtual void set_calibration(const LoadCellCalibration &calibration) { adapter_.set_calibration(calibration); }
+    virtual const LoadCellCalibration &get_calibration(void) const { return adapter_.get_calibration(); }
+
+private:
+    Adapter &adapter_;
+};
+
+
+#endif  // __LOADCELL_ADC_H__
@@ -18,6 +18,14 @@ using namespace events;
 uint8_t tx_buffer[30];
 uint8_t rx_buffer[30];
 
+static char lrw_status[sizeof(tx_buffer)];  // Application status sent instead of the sensor value while set
+
+static uint32_t lrw_period_ms;              // Fixed reporting period, 0: as often as the duty cycle allows
+static uint32_t lrw_lead_ms;
+static Callback<void()> lrw_before_uplink;  // Called lrw_lead_ms before every periodic uplink
+static bool lrw_connected;                  // Event thread only
+static int lrw_periodic_id;                 // Next lrw_periodic() event, 0: not armed
+
 static LoRaWANInterface lorawan(radio);     // Constructing Mbed LoRaWANInterface 
                                             //  and passing it the radio object from lora_radio_helper.
 
@@ -100,8 +108,21 @@ static void lrw_send_message()
     uint16_t packet_len;
     int16_t retcode;
     int sensor_value = 5555;  // Read data value
+    char status[sizeof(lrw_status)];
 
-    packet_len = sprintf((char *) tx_buffer, "Dummy Sensor Value is %d", sensor_value);
+    // Only the copy under the lock, the formatting runs with interrupts on
+    core_util_critical_section_enter();
+    memcpy(status, lrw_status, sizeof(status));
+    core_util_critical_section_exit();
+
+    if (status[0] != '\0')
+    {
+        packet_len = snprintf((char *) tx_buffer, sizeof(tx_buffer), "%s", status);
+    }
+    else
+    {
+        packet_len = sprintf((char *) tx_buffer, "Dummy Sensor Value is %d", sensor_value);
+    }
 
     retcode = lorawan.send(MBED_CONF_LORA_APP_PORT, tx_buffer, packet_len, MSG_UNCONFIRMED_FLAG);
 
@@ -128,6 +149,65 @@ static void lrw_send_message()
 }
 
 
+/******************************************************************************
+ * Sets the status reported by the next uplinks (NULL or "" to clear)
+ ******************************************************************************/
+void lrw_set_status(const char *status)
+{
+    core_util_critical_section_enter();
+    if (status == NULL)
+    {
+        lrw_status[0] = '\0';
+    }
+    else
+    {
+        strncpy(lrw_status, status, sizeof(lrw_status) - 1);
+        lrw_status[sizeof(lrw_status) - 1] = '\0';
+    }
+    core_util_critical_section_exit();
+}
+
+
+/******************************************************************************
+ * Fixed reporting period
+ *
+ * The application gets lead_ms before each uplink, e.g. to power up and read a
+ * sensor that is shut down in between; the callback runs on the LoRaWAN event
+ * thread and must only post the work elsewhere. Call after lrw_init(); the
+ * first uplink follows the join.
+ ******************************************************************************/
+static void lrw_periodic()
+{
+    lrw_periodic_id = ev_queue.call_in(lrw_period_ms, lrw_periodic);
+    if (lrw_before_uplink)
+    {
+        lrw_before_uplink();
+    }
+    ev_queue.call_in(lrw_lead_ms, lrw_send_message);
+}
+
+// On the event thread, from lrw_set_period() and the CONNECTED event
+static void lrw_arm_periodic()
+{
+    if (!lrw_connected || lrw_period_ms == 0 || lrw_periodic_id != 0)
+    {
+        return;
+    }
+    lrw_periodic();
+}
+
+void lrw_set_period(uint32_t period_ms, Callback<void()> before_uplink, uint32_t lead_ms)
+{
+    lrw_period_ms = period_ms;
+    lrw_lead_ms = (lead_ms < period_ms) ? lead_ms : period_ms;
+    lrw_before_uplink = before_uplink;
+    if (period_ms > 0)
+    {
+        ev_queue.call(lrw_arm_periodic);  // Starts at once if the join is already done
+    }
+}
+
+
 /******************************************************************************
  * Receive a message from the Network Server
  ******************************************************************************/
@@ -160,6 +240,11 @@ static void lora_event_handler(lorawan_event_t event)
     switch (event) {
         case CONNECTED:
             tr_debug("%s: Connection - Successful\r\n", __FUNCTION__);
+            lrw_connected = true;
+            if (lrw_period_ms > 0) {
+                lrw_arm_periodic();  // lrw_periodic() sends
+                break;
+            }
             if (MBED_CONF_LORA_DUTY_CYCLE_ON) {
                 lrw_send_message();
             } else {
@@ -168,13 +253,14 @@ static void lora_event_handler(lorawan_event_t event)
             break;
 
         case DISCONNECTED:
+            lrw_connected = false;
             ev_queue.break_dispatch();
             tr_debug("%s: Disconnected Successfully\r\n", __FUNCTION__);
             break;
 
         case TX_DONE:
             tr_debug("%s: Message Sent to Network Server\r\n", __FUNCTION__);
-            if (MBED_CONF_LORA_DUTY_CYCLE_ON) {
+            if (MBED_CONF_LORA_DUTY_CYCLE_ON && lrw_period_ms == 0) {
                 lrw_send_message();
             }
             break;
@@ -186,7 +272,7 @@ static void lora_event_handler(lorawan_event_t event)
             tr_debug("%s: Transmission Error - EventCode = %d\r\n", __FUNCTION__, event);
 
             // try again
-            if (MBED_CONF_LORA_DUTY_CYCLE_ON) {
+            if (MBED_CONF_LORA_DUTY_CYCLE_ON && lrw_period_ms == 0) {
                 lrw_send_message();
             }
             break;
@@ -207,7 +293,7 @@ static void lora_event_handler(lorawan_event_t event)
 
         case UPLINK_REQUIRED:
             tr_debug("%s: Uplink required by NS\r\n", __FUNCTION__);
-            if (MBED_CONF_LORA_DUTY_CYCLE_ON) {
+            if (MBED_CONF_LORA_DUTY_CYCLE_ON || lrw_period_ms > 0) {
                 lrw_send_message();
             }
             break;
@@ -27,3 +27,5 @@
  * Functions
  ******************************************************************************/
 int lrw_init();
+void lrw_set_status(const char *status);
+void lrw_set_period(uint32_t period_ms, mbed::Callback<void()> before_uplink, uint32_t lead_ms);
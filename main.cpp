@@ -8,12 +8,21 @@
 #include "Adafruit_SSD1306.h"
 #include "Hx711.h"
 #include "ADS1231.h"
+#include "ADS1232.h"
+#include "ADS1231Calibration.h"
 #include "ADS1220.h"
+#include "ADS1220Decimator.h"
+#include "ADS1220Config.h"
+#include "ADS1220OffsetTracker.h"
+#include "ADS1220AuxMonitor.h"
 
 #include "trace_helper.h"
 #define TRACE_GROUP "main"
 
 #include "lorawan_reporter.h"
+#include "benchmark.h"
+#include "loadcell_adc.h"
+#include "spsc_queue.h"
 
 
 /******************************************************************************
@@ -27,6 +36,11 @@
     #define __ADS1232__
     #elif MBED_CONF_APP_ADC_SELECTED == 2
     #define __ADS1220__
+    #elif MBED_CONF_APP_ADC_SELECTED == 3
+    #define __HX711__
+    #define __ADS1232__
+    #define __ADS1220__
+    #define __ADC_ALL__  // Side by side on the same load, each on its own timing
     #endif
 
 #else
@@ -45,6 +59,11 @@
 #endif
 
 
+#if defined(MBED_CONF_APP_BENCHMARK_ENABLE) && MBED_CONF_APP_BENCHMARK_ENABLE == 1
+#define __BENCHMARK__
+#endif
+
+
 #define BLINKING_RATE_MS 1000
 #define TEST_AMOUNT 20
 #define LSB_SIZE(PGA, VREF) ((VREF/PGA) / (((long int)1<<23)))
@@ -120,30 +139,117 @@ Adafruit_SSD1306_I2c gOled2(gI2C, P_5, SSD_I2C_ADDRESS, 64, 128);
 #define HX711_VREF 5.
 #define HX711_CAL_WEIGHT    100.  // 100g
 #define HX711_CAL_SCALE     (HX711_CAL_WEIGHT / (float)(HX711_CAL_RAW - HX711_CAL_OFFSET))
-Hx711 loadcell_hx711(P_8, P_9, HX711_CAL_OFFSET, HX711_CAL_SCALE, HX711_PGA);  // Hx711(PinName pin_sck, PinName pin_dt, int offset, float scale, uint8_t gain = 128)
+#if defined(MBED_CONF_APP_HX711_SPI_ENABLE) && MBED_CONF_APP_HX711_SPI_ENABLE == 1
+#ifdef __ADC_ALL__
+#error "adc_selected 3 bit-bangs the HX711: hx711_spi_enable must be false"
+#endif
+SpiBitstream hx711_spi(P_8, P_9);  // SpiBitstream(PinName pin_clk = MOSI, PinName pin_data = MISO, PinName pin_spi_sclk = NC)
+#define HX711_TRANSPORT     (&hx711_spi)
+#else
+#define HX711_TRANSPORT     NULL
+#endif
+#ifdef MBED_CONF_APP_HX711_RATE_PIN
+#define HX711_RATE_PIN      MBED_CONF_APP_HX711_RATE_PIN
+#else
+#define HX711_RATE_PIN      NC
+#endif
+Hx711 loadcell_hx711(P_8, P_9, HX711_CAL_OFFSET, HX711_CAL_SCALE, HX711_PGA, HX711_TRANSPORT, HX711_RATE_PIN);  // Hx711(PinName pin_sck, PinName pin_dt, int offset, float scale, uint8_t gain = 128, SpiBitstream *transport = NULL, PinName pin_rate = NC)
 // Hx711 loadcell_hx711(P_8, P_9, 25950, -0.0046522447, HX711_PGA);  // Hx711(PinName pin_sck, PinName pin_dt, int offset, float scale, uint8_t gain = 128)
-Ticker hx711_ticker;
-struct
+Thread hx711_thread(osPriorityHigh);  // Clocks the conversions out, interrupts masked per clock high phase only
+EventQueue hx711_queue(4 * EVENTS_EVENT_SIZE);
+#define HX711_RECORDS HX711_RING_SIZE  // Channel A samples buffered for the main loop
+static uint16_t hx711_drain(Hx711::Channel channel, int32_t *raw_fine, uint32_t *timestamp)
 {
-    int32_t raw;
-    float volt;
-    float mass;
-} hx711_sample;
+    // Average every sample buffered since the previous call
+    Hx711::Sample sample;
+    int64_t sum = 0;
+    uint16_t count = 0;
 
-void hx711_read(void)
-{
-    hx711_sample.raw  = loadcell_hx711.readRaw();
-    hx711_sample.volt = hx711_sample.raw * LSB_SIZE(HX711_PGA, HX711_VREF);
-    hx711_sample.mass = loadcell_hx711.read();
+    while (loadcell_hx711.pop_sample(&sample, channel))
+    {
+        sum += sample.raw_fine;
+        *timestamp = sample.timestamp;
+        count++;
+    }
+    if (count > 0)
+        *raw_fine = sum / count;
+
+    return count;
 }
 
 void hx711_init(void)
 {
     // loadcell_hx711.set_scale();
     // loadcell_hx711.set_offset(124);
-    hx711_ticker.attach(&hx711_read, 1);
+    #if defined(MBED_CONF_APP_HX711_CHANNEL_B) && MBED_CONF_APP_HX711_CHANNEL_B > 0
+    loadcell_hx711.set_scan(HX711_PGA, MBED_CONF_APP_HX711_CHANNEL_B, MBED_CONF_APP_HX711_CHANNEL_B);
+    #endif
+    #if defined(MBED_CONF_APP_HX711_RATE_SPS)
+    loadcell_hx711.set_rate(MBED_CONF_APP_HX711_RATE_SPS);
+    #endif
+    #if defined(MBED_CONF_APP_HX711_DECIMATION)
+    loadcell_hx711.set_decimation(MBED_CONF_APP_HX711_DECIMATION);
+    #endif
+    hx711_thread.start(callback(&hx711_queue, &EventQueue::dispatch_forever));
+    loadcell_hx711.start_sampling(&hx711_queue);  // DOUT falling edges post the readouts to the HX711 thread
 }
 
+static_assert(HX711_FRAC_BITS == LOADCELL_FRAC_BITS, "Hx711 fine values are passed on unscaled");
+const LoadCellCalibration hx711_calibration = { HX711_CAL_OFFSET, HX711_CAL_SCALE, LSB_SIZE(HX711_PGA, HX711_VREF) };
+
+class Hx711LoadCell : public LoadCellAdcBase<Hx711LoadCell>
+{
+public:
+    Hx711LoadCell() :
+        LoadCellAdcBase<Hx711LoadCell>("HX711", hx711_calibration),
+        raw_b_(0),
+        count_b_(0) {
+    }
+
+    void start_adc(void) { hx711_init(); }
+
+    LoadCellStatus read_adc(LoadCellReading *reading)
+    {
+        Hx711::Sample sample;
+
+        // Channel A sample by sample; B, only traced, as one mean once A is drained
+        if (!loadcell_hx711.pop_sample(&sample, Hx711::CHANNEL_A))
+        {
+            int32_t fine;
+            uint32_t timestamp;
+
+            count_b_ = hx711_drain(Hx711::CHANNEL_B, &fine, &timestamp);
+            if (count_b_ > 0)
+                raw_b_ = fine >> HX711_FRAC_BITS;
+            return LOADCELL_NO_DATA;
+        }
+
+        reading->raw       = sample.raw;
+        reading->fine      = sample.raw_fine;
+        reading->count     = loadcell_hx711.get_decimation();
+        reading->timestamp = sample.timestamp;
+        return LOADCELL_OK;
+    }
+
+    void trace_adc(uint16_t n, LoadCellStatus status)
+    {
+        tr_debug("[%d] HX711: masked<=%.1fus corrupted=%lu overruns=%lu\r\n", n,
+            loadcell_hx711.get_max_masked_us(),
+            loadcell_hx711.get_corrupted_count(),
+            loadcell_hx711.get_overrun_count()
+            );
+        if (count_b_ > 0)
+        {
+            tr_debug("[%d] HX711 B: raw=%ld n=%u\r\n", n, raw_b_, count_b_);
+        }
+    }
+
+private:
+    int32_t raw_b_;  // Channel B, gain 32
+    uint16_t count_b_;
+};
+Hx711LoadCell hx711_loadcell;
+
 #endif
 
 
@@ -157,21 +263,153 @@ void hx711_init(void)
 #define ADS1232_PGA 128
 #define ADS1232_VREF 5.
 #define ADS1232_CAL_MASS 0.100  // 100g
-ADS1231  loadcell_ads1232(P_25, P_29);  // ADS1231::ADS1231 ( PinName SCLK, PinName DOUT )
-Ticker ads1232_ticker;
+#define ADS1232_CAL_MASS_G (ADS1232_CAL_MASS * 1000.f)  // ADS1231_SCALE_g: readings in g
+#define ADS1232_LSB (ADS1232_VREF / ADS1232_PGA / 16777215.f)  // +-VREF/2 full scale, as ADS1231_CalculateVoltage()
+#if defined(MBED_CONF_APP_ADS1232_SPI_ENABLE) && MBED_CONF_APP_ADS1232_SPI_ENABLE == 1
+#ifdef __ADC_ALL__
+#error "adc_selected 3 bit-bangs the ADS1232: ads1232_spi_enable must be false"
+#endif
+SpiBitstream ads1232_spi(P_25, P_29);  // SpiBitstream(PinName pin_clk = MOSI, PinName pin_data = MISO, PinName pin_spi_sclk = NC)
+#define ADS1232_TRANSPORT   (&ads1232_spi)
+#else
+#define ADS1232_TRANSPORT   NULL
+#endif
+#ifdef MBED_CONF_APP_ADS1232_SPEED_PIN
+#define ADS1232_SPEED_PIN   MBED_CONF_APP_ADS1232_SPEED_PIN
+#define ADS1232_GAIN0_PIN   MBED_CONF_APP_ADS1232_GAIN0_PIN
+#define ADS1232_GAIN1_PIN   MBED_CONF_APP_ADS1232_GAIN1_PIN
+#define ADS1232_A0_PIN      MBED_CONF_APP_ADS1232_A0_PIN
+#define ADS1232_TEMP_PIN    MBED_CONF_APP_ADS1232_TEMP_PIN
+#else
+#define ADS1232_SPEED_PIN   NC
+#define ADS1232_GAIN0_PIN   NC
+#define ADS1232_GAIN1_PIN   NC
+#define ADS1232_A0_PIN      NC
+#define ADS1232_TEMP_PIN    NC
+#endif
+const LoadCellCalibration ads1232_uncalibrated = { 0, 1.f, ADS1232_LSB };
+ADS1232  loadcell_ads1232(P_25, P_29, ADS1232_SPEED_PIN, ADS1232_GAIN0_PIN, ADS1232_GAIN1_PIN, ADS1232_A0_PIN, ADS1232_TEMP_PIN, ADS1232_TRANSPORT);  // ADS1232::ADS1232 ( PinName SCLK, PinName DOUT, PinName SPEED = NC, PinName GAIN0 = NC, PinName GAIN1 = NC, PinName A0 = NC, PinName TEMP = NC, SpiBitstream* transport = NULL )
+Thread ads1232_thread;  // Waits for DRDY in thread context so the core sleeps between conversions
+EventQueue ads1232_queue(4 * EVENTS_EVENT_SIZE);
 struct 
 {
-    ADS1231::ADS1231_status_t status;
-    ADS1231::Vector_count_t   count;
+    ADS1231::Vector_count_t   count;  // Calibration points and the last conversion, ADS1232 thread only
     uint8_t num_avg;
-    ADS1231::Vector_mass_t    calculated_mass;
-    ADS1231::Vector_voltage_t calculated_volt;
+    uint32_t raw_b;  // AIN2 mean, when scanned
 } ads1232_sample;
 
+// One reading, published whole from the ADS1232 thread to the main loop
+typedef struct
+{
+    ADS1231::ADS1231_status_t status;
+    uint32_t raw;
+    ADS1231::Vector_stats_t stats;
+    uint32_t raw_b;
+    uint32_t timestamp;  // us_ticker time the read completed
+} Ads1232Record;
+#define ADS1232_RECORDS 4
+SpscQueue<Ads1232Record, ADS1232_RECORDS> ads1232_records;
+
 void ads1232_read(void) {
-    ads1232_sample.status          = loadcell_ads1232.ADS1231_ReadRawData(&ads1232_sample.count, ads1232_sample.num_avg);
-    ads1232_sample.calculated_volt = loadcell_ads1232.ADS1231_CalculateVoltage(&ads1232_sample.count, ADS1232_VREF);
-    ads1232_sample.calculated_mass = loadcell_ads1232.ADS1231_CalculateMass(&ads1232_sample.count, ADS1232_CAL_MASS, ADS1231::ADS1231_SCALE_g);
+    Ads1232Record record;
+
+    #if defined(MBED_CONF_APP_ADS1232_CHANNEL_B) && MBED_CONF_APP_ADS1232_CHANNEL_B > 0
+    // Up to AIN1, the calibrated bridge. A failed entry is retried by the next
+    // ScanNext(), so the results go by their channel tag, not by position
+    ADS1232::ADS1232_scan_result_t result;
+    do
+    {
+        record.status = loadcell_ads1232.ADS1232_ScanNext(&result);
+        if (record.status == ADS1231::ADS1231_SUCCESS && result.myChannel == ADS1232::ADS1232_CHANNEL_AIN2)
+            ads1232_sample.raw_b = result.myStats.myMean;
+    } while (record.status == ADS1231::ADS1231_SUCCESS && result.myChannel != ADS1232::ADS1232_CHANNEL_AIN1);
+
+    if (record.status == ADS1231::ADS1231_SUCCESS)
+        ads1232_sample.count.myRawValue = result.myCount.myRawValue;
+    record.stats                    = result.myStats;  // A failed read is published too, with its status
+    #else
+    record.status                   = loadcell_ads1232.ADS1232_ReadChannel(ADS1232::ADS1232_CHANNEL_AIN1, ADS1232::ADS1232_GAIN_128,
+                                        &ads1232_sample.count, &record.stats, ads1232_sample.num_avg);
+    #endif
+    record.raw                      = ads1232_sample.count.myRawValue;
+    record.raw_b                    = ads1232_sample.raw_b;
+    record.timestamp                = us_ticker_read();
+    ads1232_records.push(record);  // Dropped and counted if the main loop fell behind
+}
+
+ADS1231Calibration ads1232_cal(loadcell_ads1232, &ads1232_queue, &ads1232_sample.count);
+struct
+{
+    volatile ADS1231Calibration::Phase phase;
+    volatile uint16_t remaining;
+    volatile bool changed;  // Shown by the main loop, the OLED is not shared between threads
+    volatile bool calibrated;
+    volatile bool config_error;  // The pins cannot select the configured inputs, nothing is read
+    LoadCellCalibration calibration;  // Handed to the adapter on the main thread once calibrated
+} ads1232_cal_state;
+
+static const char *ads1232_cal_text(ADS1231Calibration::Phase phase)
+{
+    switch (phase)
+    {
+        case ADS1231Calibration::PHASE_RESET:            return "Reset";
+        case ADS1231Calibration::PHASE_REMOVE_MASS:      return "Remove mass";
+        case ADS1231Calibration::PHASE_ZERO:             return "Zero";
+        case ADS1231Calibration::PHASE_PUT_MASS:         return "Put mass";
+        case ADS1231Calibration::PHASE_SPAN:             return "Span";
+        case ADS1231Calibration::PHASE_REMOVE_MASS_TARE: return "Remove mass again";
+        case ADS1231Calibration::PHASE_TARE:             return "Tare";
+        case ADS1231Calibration::PHASE_DONE:             return "Done";
+        case ADS1231Calibration::PHASE_FAILED:           return "Failed";
+        default:                                         return "Idle";
+    }
+}
+
+void ads1232_cal_progress(ADS1231Calibration::Phase phase, uint16_t remaining)
+{
+    if (phase != ads1232_cal_state.phase)
+    {
+        char status[16];
+        snprintf(status, sizeof(status), "CAL %s", ads1232_cal_text(phase));
+        lrw_set_status(status);
+    }
+
+    ads1232_cal_state.phase = phase;
+    ads1232_cal_state.remaining = remaining;
+    ads1232_cal_state.changed = true;
+    tr_debug("ADS1232: calibration %s %u\r\n", ads1232_cal_text(phase), remaining);
+}
+
+void ads1232_cal_done(ADS1231::ADS1231_status_t status)
+{
+    if (status != ADS1231::ADS1231_status_t::ADS1231_SUCCESS)
+    {
+        tr_debug("ADS1232: calibration failed (%d)\r\n", status);
+        lrw_set_status("CAL FAILED");
+        return;
+    }
+
+    tr_debug("ADS1232: .myRawValue_WithoutCalibratedMass > %f\r\n", ads1232_sample.count.myRawValue_WithoutCalibratedMass);
+    tr_debug("ADS1232: .myRawValue_WithCalibratedMass > %f\r\n", ads1232_sample.count.myRawValue_WithCalibratedMass);
+    tr_debug("ADS1232: .myRawValue_TareWeight > %f\r\n", ads1232_sample.count.myRawValue_TareWeight);
+    lrw_set_status(NULL);
+
+    // ads1232_sample.count.myRawValue_WithoutCalibratedMass = 8385827;
+    // ads1232_sample.count.myRawValue_WithCalibratedMass = 8590153;  // @31g calibrated mass
+    // ads1232_sample.count.myRawValue_TareWeight = -0.025879;
+
+    // The ADS1231_CalculateMass() model, mass = m * code - m * c_zs - w_t, as offset and scale
+    float m = ADS1232_CAL_MASS_G / (ads1232_sample.count.myRawValue_WithCalibratedMass - ads1232_sample.count.myRawValue_WithoutCalibratedMass);
+    ads1232_cal_state.calibration.offset        = (LoadCellRaw)(ads1232_sample.count.myRawValue_WithoutCalibratedMass + ads1232_sample.count.myRawValue_TareWeight / m + 0.5f);
+    ads1232_cal_state.calibration.scale         = m;
+    ads1232_cal_state.calibration.volt_per_code = ADS1232_LSB;
+    core_util_atomic_store_explicit_bool(&ads1232_cal_state.calibrated, true, mbed_memory_order_release);  // After the calibration
+
+    #if defined(MBED_CONF_APP_ADS1232_OFFSET_CAL_PERIOD) && MBED_CONF_APP_ADS1232_OFFSET_CAL_PERIOD > 0
+    loadcell_ads1232.ADS1232_SetCalibrationSchedule(MBED_CONF_APP_ADS1232_OFFSET_CAL_PERIOD * 1000, 0);
+    loadcell_ads1232.ADS1232_CalibrateOffset();  // Datasheet: once after power-up, then on the schedule
+    #endif
+    ads1232_queue.call_every(1000, ads1232_read);  // Blocking read (up to ADS1231_TIMEOUT_MS) off the ISR
 }
 
 void ads1232_init(void)
@@ -182,88 +420,132 @@ void ads1232_init(void)
     gOled2.display();
     #endif
 
-    ads1232_sample.num_avg = 1;
-    uint8_t num_avg_cal = 4;
-    ADS1231::ADS1231_status_t sts;
+    ads1232_sample.num_avg = 4;  // 400 ms @ 10 SPS, gives a noise estimate per reading
 
-    // Reset and wake the ADS1232 up
-    sts = loadcell_ads1232.ADS1231_PowerDown();
-    if (sts == ADS1231::ADS1231_status_t::ADS1231_FAILURE)
+    #if defined(MBED_CONF_APP_ADS1232_SPEED_SPS) && MBED_CONF_APP_ADS1232_SPEED_SPS == 80
+    if (loadcell_ads1232.ADS1232_SetSpeed(ADS1232::ADS1232_SPEED_80SPS) != ADS1231::ADS1231_SUCCESS)
     {
-        tr_debug("ADS1232 fail on power-down\r\n");
+        // With SPEED strapped the chip stays at its rate while the timeouts would follow 80 SPS
+        tr_debug("ADS1232: ads1232_speed_sps 80 needs ads1232_speed_pin\r\n");
+        lrw_set_status("ADS1232 no SPEED");
+        #ifdef __OLED__
+        gOled2.clearDisplay();
+        gOled2.printf("ADS1232: no SPEED pin\r\n");
+        gOled2.display();
+        #endif
+        ads1232_cal_state.config_error = true;
+        return;
     }
+    #endif
 
-    sts = loadcell_ads1232.ADS1231_Reset();
-    if (sts == ADS1231::ADS1231_status_t::ADS1231_FAILURE)
+    #if defined(MBED_CONF_APP_ADS1232_CHANNEL_B) && MBED_CONF_APP_ADS1232_CHANNEL_B > 0
+    // AIN2 first so that each ads1232_read() ends on AIN1; each switch drops ADS1232_SETTLE_DISCARD conversions
+    const ADS1232::ADS1232_scan_t scan[2] = {
+        { ADS1232::ADS1232_CHANNEL_AIN2, ADS1232::ADS1232_GAIN_128, MBED_CONF_APP_ADS1232_CHANNEL_B },
+        { ADS1232::ADS1232_CHANNEL_AIN1, ADS1232::ADS1232_GAIN_128, ads1232_sample.num_avg }
+    };
+    if (loadcell_ads1232.ADS1232_SetScan(scan, 2) != ADS1231::ADS1231_SUCCESS)
     {
-        tr_debug("ADS1232 fail on reset\r\n");
+        // With A0 strapped every "AIN2" read would be AIN1 again
+        tr_debug("ADS1232: ads1232_channel_b needs ads1232_a0_pin\r\n");
+        lrw_set_status("ADS1232 no A0");
+        #ifdef __OLED__
+        gOled2.clearDisplay();
+        gOled2.printf("ADS1232: no A0 pin\r\n");
+        gOled2.display();
+        #endif
+        ads1232_cal_state.config_error = true;
+        return;
     }
-    ThisThread::sleep_for(1000);
-
-    /** CALIBRATION time start!  **/
-    // 1. REMOVE THE MASS ON THE LOAD CELL ( ALL LEDs OFF ). Read data without any mass on the load cell
-    // aux = myWeightSensor.ADS1231_ReadData_WithoutMass ( &myData, 4 );
-    // 2. PUT A KNOWN MASS ON THE LOAD CELL ( JUST LED1 ON ). Read data with an user-specified calibration mass
-    // aux = myWeightSensor.ADS1231_ReadData_WithCalibratedMass ( &myData, 4 );
+    #endif
 
-    // Calculating the tare weight ( JUST LED3 ON )
-    // aux = myWeightSensor.ADS1231_SetAutoTare ( ADS1231::ADS1231_SCALE_kg, &myData, 5 );
+    // Reset, zero, span and tare run on the ADS1232 thread, main keeps going
+    ads1232_thread.start(callback(&ads1232_queue, &EventQueue::dispatch_forever));
+    ads1232_cal.attach_progress(ads1232_cal_progress);
+    ads1232_cal.attach_done(ads1232_cal_done);
+    ads1232_cal.start(ADS1232_CAL_MASS, ADS1231::ADS1231_SCALE_g);
+}
 
-    int i;
-    tr_debug("ADS1232: please remove the calibrated mass before calibration ...");
-    #ifdef __OLED__
-    gOled2.printf("Remove mass...\r\n");
-    gOled2.display();
-    #endif
-    for (i = 5; i > 0; i--)
-    {
-        wait(1);
-        tr_debug("%d ", i);
+class Ads1232LoadCell : public LoadCellAdcBase<Ads1232LoadCell>
+{
+public:
+    Ads1232LoadCell() :
+        LoadCellAdcBase<Ads1232LoadCell>("ADS1232", ads1232_uncalibrated),
+        calibrated_(false) {
     }
-    wait(1);
-    tr_debug("WIP.\r\n");
 
-    loadcell_ads1232.ADS1231_ReadData_WithoutMass(&ads1232_sample.count, num_avg_cal);
-    tr_debug("ADS1232: .myRawValue_WithoutCalibratedMass > %f\r\n", ads1232_sample.count.myRawValue_WithoutCalibratedMass);
+    void start_adc(void) { ads1232_init(); }
 
-    tr_debug("ADS1232: please put a calibrated mass %.1fg on the scale ...", ADS1232_CAL_MASS * 1000);
-    #ifdef __OLED__
-    gOled2.printf("Put mass...\r\n");
-    gOled2.display();
-    #endif
-    for (i = 10; i > 0; i--)
+    LoadCellStatus read_adc(LoadCellReading *reading)
     {
-        wait(1);
-        tr_debug("%d ", i);
-    }
-    wait(1);
-    tr_debug("WIP.\r\n");
+        if (ads1232_cal_state.config_error)
+            return LOADCELL_ERROR;
+        if (!core_util_atomic_load_explicit_bool(&ads1232_cal_state.calibrated, mbed_memory_order_acquire))
+            return LOADCELL_CALIBRATING;
+        if (!calibrated_)
+        {
+            set_calibration(ads1232_cal_state.calibration);
+            calibrated_ = true;
+        }
+        // Burst by burst, each the mean of its conversions
+        if (!ads1232_records.pop(&record_))
+            return LOADCELL_NO_DATA;
 
-    loadcell_ads1232.ADS1231_ReadData_WithCalibratedMass(&ads1232_sample.count, num_avg_cal);
-    tr_debug("ADS1232: .myRawValue_WithCalibratedMass > %f\r\n", ads1232_sample.count.myRawValue_WithCalibratedMass);
+        switch (record_.status)
+        {
+            case ADS1231::ADS1231_SUCCESS:          break;
+            case ADS1231::ADS1231_DEVICE_NOT_FOUND: return LOADCELL_NOT_FOUND;
+            case ADS1231::ADS1231_TIMEOUT:          return LOADCELL_TIMEOUT;
+            default:                                return LOADCELL_ERROR;
+        }
 
-    tr_debug("ADS1232: please remove the calibrated mass before taring ...");
-    #ifdef __OLED__
-    gOled2.printf("Remove mass again...\r\n");
-    gOled2.display();
-    #endif
-    for (i = 5; i > 0; i--)
-    {
-        wait(1);
-        tr_debug("%d ", i);
+        set_raw(reading, (LoadCellRaw)record_.raw, record_.stats.mySamples, record_.timestamp);
+        if (record_.stats.myFlags & ADS1231_STATS_OFFSET_CAL)
+            return LOADCELL_DISCARDED;
+        return LOADCELL_OK;
     }
-    wait(1);
-    tr_debug("WIP.\r\n");
 
-    loadcell_ads1232.ADS1231_SetAutoTare(ADS1232_CAL_MASS, ADS1231::ADS1231_SCALE_g, &ads1232_sample.count, num_avg_cal);
-    tr_debug("ADS1232: .myRawValue_TareWeight > %f\r\n", ads1232_sample.count.myRawValue_TareWeight);
-
-    // ads1232_sample.count.myRawValue_WithoutCalibratedMass = 8385827;
-    // ads1232_sample.count.myRawValue_WithCalibratedMass = 8590153;  // @31g calibrated mass
-    // ads1232_sample.count.myRawValue_TareWeight = -0.025879;
+    void trace_adc(uint16_t n, LoadCellStatus status)
+    {
+        if (status == LOADCELL_CALIBRATING)
+        {
+            if (ads1232_cal_state.changed)
+            {
+                ads1232_cal_state.changed = false;
+                #ifdef __OLED__
+                gOled2.clearDisplay();
+                gOled2.setTextCursor(0, 0);
+                gOled2.printf("Cal: %s %u\r\n", ads1232_cal_text(ads1232_cal_state.phase), ads1232_cal_state.remaining);
+                gOled2.display();
+                #endif
+            }
+            return;
+        }
+        if (status == LOADCELL_DISCARDED)
+        {
+            tr_debug("ADS1232: offset recalibrated (%lu), sample left out of the average\r\n",
+                loadcell_ads1232.ADS1232_GetCalibrationCount());
+        }
+        if (status != LOADCELL_OK && status != LOADCELL_DISCARDED)
+        {
+            return;
+        }
+        #if defined(MBED_CONF_APP_ADS1232_CHANNEL_B) && MBED_CONF_APP_ADS1232_CHANNEL_B > 0
+        tr_debug("[%d] ADS1232: AIN2 raw=%lu, discarded=%lu\r\n", n,
+            record_.raw_b, loadcell_ads1232.ADS1232_GetDiscardedCount());
+        #endif
+        tr_debug("[%d] ADS1232: var=%lu p-p=%lu dropped=%lu\r\n", n,
+            (uint32_t)record_.stats.myVariance,
+            record_.stats.myMax - record_.stats.myMin,
+            ads1232_records.get_overrun_count()
+            );
+    }
 
-    ads1232_ticker.attach(&ads1232_read, 1);  // the address of the function to be attached ( readDATA ) and the interval ( 0.5s ) ( JUST LED4 BLINKING )
-}
+private:
+    bool calibrated_;  // ads1232_cal_state.calibration applied
+    Ads1232Record record_;  // The reading being reported
+};
+Ads1232LoadCell ads1232_loadcell;
 
 #endif
 
@@ -283,45 +565,383 @@ void ads1232_init(void)
 #define ADS1220_VREF 5.
 #define ADS1220_CAL_WEIGHT    100.  // 100g
 #define ADS1220_CAL_SCALE     (ADS1220_CAL_WEIGHT / (float)(ADS1220_CAL_RAW - ADS1220_CAL_OFFSET))
-ADS1220 loadcell_ads1220(P_13, P_12, P_14, P_15);  //(PinName mosi, PinName miso, PinName sclk, PinName cs)
-InterruptIn pin_drdy(P_20);
+#if defined(MBED_CONF_APP_ADS1220_DRDY_ON_DOUT) && MBED_CONF_APP_ADS1220_DRDY_ON_DOUT == 1
+#define ADS1220_DRDY_PIN    NC  // DRDY is signalled on DOUT/MISO, P_20 is free
+#else
+#define ADS1220_DRDY_PIN    P_20
+#endif
+ADS1220 loadcell_ads1220(P_13, P_12, P_14, P_15, ADS1220_DRDY_PIN);  //(PinName mosi, PinName miso, PinName sclk, PinName cs, PinName drdy = NC)
+Thread ads1220_thread(osPriorityAboveNormal);  // Starts the SPI transfers and takes the full blocks
+EventQueue ads1220_queue(8 * EVENTS_EVENT_SIZE);
 Ticker ads1220_ticker;
-struct
+// ADS1220Bridge (ADS1220Config.h): bridge on AIN1-AIN2, ratiometric to the excitation on REFP1/REFN1
+typedef ADS1220Bridge
+    ::WithRejection<ADS1220Rejection::Off>
+    ::WithRate<ADS1220Rate::SPS1000, ADS1220Mode::Turbo> ADS1220BridgeTurbo;  // 2 kSPS
+#if defined(MBED_CONF_APP_ADS1220_TURBO) && MBED_CONF_APP_ADS1220_TURBO == 1
+#define ADS1220_TURBO
+#define ADS1220_TURBO_SPS   2000
+#define ADS1220_OUTPUT_HZ   MBED_CONF_APP_ADS1220_OUTPUT_HZ
+ADS1220Decimator ads1220_decimator(ADS1220_TURBO_SPS / ADS1220_OUTPUT_HZ);
+#endif
+#if defined(MBED_CONF_APP_ADS1220_SCAN) && MBED_CONF_APP_ADS1220_SCAN == 1
+#ifdef ADS1220_TURBO
+#error "ads1220_scan and ads1220_turbo cannot be combined: the decimator needs one uniform stream"
+#endif
+#define ADS1220_SCAN
+#define ADS1220_SCAN_BRIDGE  0
+#define ADS1220_SCAN_VREF    1
+#define ADS1220_VREF_INTERNAL 2.048
+// The bridge is ratiometric on REFP1/REFN1, so the excitation (AVDD) is monitored against the internal reference
+const ADS1220ScanEntry ads1220_scan[2] = {
+    { ADS1220_MUX_1_2,  ADS1220_GAIN_128, 0,                  ADS1220_VREF_EX_AIN, 8, 1 },  // Bridge
+    { ADS1220_MUX_AVDD, ADS1220_GAIN_1,   ADS1220_PGA_BYPASS, ADS1220_VREF_INT,    1, 1 },  // Excitation monitor, (AVDD-AVSS)/4
+};
+#endif
+#if defined(MBED_CONF_APP_ADS1220_REPORT_PERIOD_S) && MBED_CONF_APP_ADS1220_REPORT_PERIOD_S > 0
+#if defined(ADS1220_TURBO) || defined(ADS1220_SCAN)
+#error "ads1220_report_period_s bursts cannot be combined with ads1220_turbo or ads1220_scan"
+#endif
+#define ADS1220_BURST
+#define ADS1220_PERIOD_MS     (MBED_CONF_APP_ADS1220_REPORT_PERIOD_S * 1000UL)
+#define ADS1220_BURST_COUNT   MBED_CONF_APP_ADS1220_BURST
+#define ADS1220_BURST_MARGIN_MS 500  // Wake-up and SPI on top of the conversions
+// Typical ADC supply current (AVDD + DVDD, PGA on, SBAS501) and the bridge, on through PSW only while awake
+#if defined(MBED_CONF_APP_ADS1220_DUTY_CYCLE) && MBED_CONF_APP_ADS1220_DUTY_CYCLE == 1
+typedef ADS1220Bridge
+    ::WithRate<ADS1220Rate::SPS20, ADS1220Mode::DutyCycle> ADS1220BridgeBurst;  // 5 SPS
+#define ADS1220_ACTIVE_ADC_UA 120.f
+#else
+typedef ADS1220Bridge
+    ::WithContinuous<false> ADS1220BridgeBurst;  // Single-shot, 20 SPS
+#define ADS1220_ACTIVE_ADC_UA 315.f
+#endif
+#define ADS1220_SHUTDOWN_UA   0.4f
+#ifndef ADS1220_BRIDGE_OHM
+#define ADS1220_BRIDGE_OHM    1000.f  // Load cell input resistance
+#endif
+#define ADS1220_ACTIVE_UA     (ADS1220_ACTIVE_ADC_UA + ADS1220_VREF / ADS1220_BRIDGE_OHM * 1e6f)
+#endif
+#if defined(MBED_CONF_APP_ADS1220_OFFSET_INTERVAL_S) && MBED_CONF_APP_ADS1220_OFFSET_INTERVAL_S > 0
+#if defined(ADS1220_TURBO) || defined(ADS1220_BURST)
+#error "ads1220_offset_interval_s needs the 20 SPS stream: not with ads1220_turbo or ads1220_report_period_s"
+#endif
+#define ADS1220_OFFSET_TRACK
+ADS1220OffsetTracker ads1220_offset(loadcell_ads1220, MBED_CONF_APP_ADS1220_OFFSET_INTERVAL_S * 1000UL);
+
+// ADS1220_CAL_OFFSET includes the ADC offset of the calibration; what is removed is the drift since start-up
+int32_t ads1220_offset_drift(void)
 {
-    volatile bool available;
-    int32_t offset;
-    float scale;
-    int32_t raw;
-    float volt;
-    float mass;
-} ads1220_sample = { false, ADS1220_CAL_OFFSET, ADS1220_CAL_SCALE, };
-
-void ads1220_data_ready(void)
+    static int32_t reference;
+    static bool referenced = false;
+
+    if (!ads1220_offset.IsValid())
+    {
+        return 0;
+    }
+    if (!referenced)
+    {
+        reference = ads1220_offset.GetOffset();
+        referenced = true;
+    }
+    return ads1220_offset.GetOffset() - reference;
+}
+#endif
+#if defined(MBED_CONF_APP_ADS1220_AUX_INTERVAL_S) && MBED_CONF_APP_ADS1220_AUX_INTERVAL_S > 0
+#if defined(ADS1220_TURBO) || defined(ADS1220_BURST)
+#error "ads1220_aux_interval_s needs the 20 SPS stream: not with ads1220_turbo or ads1220_report_period_s"
+#endif
+#define ADS1220_AUX
+#define ADS1220_TEMP_REF_C    25.f
+#ifndef ADS1220_RATIOMETRIC
+#define ADS1220_RATIOMETRIC   1  // REFP1/REFN1 across the bridge excitation: AVDD changes cancel out
+#endif
+ADS1220AuxMonitor ads1220_aux(loadcell_ads1220, MBED_CONF_APP_ADS1220_AUX_INTERVAL_S * 1000UL);
+#endif
+
+// Per-conversion correction of the bridge readings: cached temperature and excitation factor
+static inline int32_t ads1220_correct(int32_t raw)
 {
-    // ads1220_sample.raw       = loadcell_ads1220.ReadData();
-    // ads1220_sample.volt      = ads1220_sample.raw * LSB_SIZE(ADS1220_PGA, ADS1220_VREF);
-    ads1220_sample.available = true;
+    #ifdef ADS1220_AUX
+    return ads1220_aux.Correct(raw, ADS1220_CAL_OFFSET);
+    #else
+    return raw;
+    #endif
 }
+// One conversion, decimated output or burst, published whole from the ADS1220 thread to the main loop
+typedef struct
+{
+    int32_t raw;  // A conversion, a decimated output in turbo mode or the mean of a burst
+    uint16_t count;  // Conversions behind raw
+    uint16_t unsettled;  // Scan: conversions left out while the MUX settled, on the first record of a block
+    uint32_t timestamp;  // us_ticker time of the newest conversion
+    int32_t vref_raw;  // Scan: mean of the excitation monitor conversions of the block
+    float duty;  // Burst: fraction of the period the ADC and bridge were powered
+    float current_ua;  // Burst: estimated average current of ADC and bridge
+} Ads1220Record;
+#ifdef ADS1220_TURBO
+#define ADS1220_RECORDS 128  // 1 s of decimated output at up to 128 Hz
+#else
+#define ADS1220_RECORDS 64  // Up to three 20-conversion blocks between two passes of the main loop
+#endif
+SpscQueue<Ads1220Record, ADS1220_RECORDS> ads1220_records;
 
-void ads1220_init(void)
+#ifdef ADS1220_TURBO
+void ads1220_decimated(int32_t value, uint32_t timestamp)
+{
+    Ads1220Record record = { 0 };
+
+    record.raw       = value;
+    record.count     = ads1220_decimator.GetRatio();
+    record.timestamp = timestamp;
+    ads1220_records.push(record);
+}
+#endif
+
+#ifdef ADS1220_BURST
+void ads1220_burst(void)
 {
-    // pin_drdy.rise(&ads1220_read);
-    pin_drdy.fall(&ads1220_data_ready);  // Interrupt routine of End-of-conversion acknowledgement
+    static int32_t data[ADS1220_BURST_COUNT];
+    char status[24];
+    int64_t sum = 0;
 
+    if (loadcell_ads1220.AcquireBurst(data, ADS1220_BURST_COUNT, 2 * 1000 / loadcell_ads1220.GetSampleRate()) != ADS1220_NO_ERROR)
+    {
+        tr_debug("ADS1220 burst: no DRDY\r\n");
+        lrw_set_status("ADS1220 error");
+        return;
+    }
+    for (uint16_t i = 0; i < ADS1220_BURST_COUNT; i++)
+    {
+        sum += data[i];
+    }
+
+    Ads1220Record record = { 0 };
+    float duty = loadcell_ads1220.GetBurstTimeUs() / (ADS1220_PERIOD_MS * 1000.f);
+    record.duty       = duty;
+    record.current_ua = duty * ADS1220_ACTIVE_UA + (1 - duty) * ADS1220_SHUTDOWN_UA;
+    record.raw        = (int32_t)(sum / ADS1220_BURST_COUNT);
+    record.timestamp  = us_ticker_read();
+    record.count      = ADS1220_BURST_COUNT;
+    ads1220_records.push(record);
+
+    // This burst is the payload of the uplink that follows
+    snprintf(status, sizeof(status), "%.2fg", (record.raw - ADS1220_CAL_OFFSET) * ADS1220_CAL_SCALE);
+    lrw_set_status(status);
+}
+
+void ads1220_before_uplink(void)
+{
+    ads1220_queue.call(ads1220_burst);  // Off the LoRaWAN thread
+}
+#endif
+
+void ads1220_block_done(const ADS1220Block *block)
+{
+    #ifdef ADS1220_TURBO
+    ads1220_decimator.Process(block);  // Too fast for the trace UART and LoRa, only the decimated rate leaves here
+    return;
+    #endif
+
+    int32_t drift = 0;
+    #ifdef ADS1220_OFFSET_TRACK
+    ads1220_offset.Process(block);
+    drift = ads1220_offset_drift();
+    #endif
+    #ifdef ADS1220_AUX
+    ads1220_aux.Process(block);
+    #endif
+
+    #ifdef ADS1220_SCAN
+    // The conversions taken while the input settled are dropped
+    int64_t vref_sum = 0;
+    uint16_t vref_count = 0;
+    uint16_t unsettled = 0;
+    for (uint16_t i = 0; i < block->Count; i++)
+    {
+        if (block->Tag[i] & ADS1220_TAG_AUX)
+        {
+            continue;
+        }
+        if (block->Tag[i] & ADS1220_TAG_UNSETTLED)
+        {
+            unsettled++;
+        }
+        else if ((block->Tag[i] & ADS1220_TAG_ENTRY) == ADS1220_SCAN_VREF)
+        {
+            vref_sum += block->Data[i];
+            vref_count++;
+        }
+    }
+
+    // The excitation monitor is a diagnostic, the bridge conversions go out one by one
+    Ads1220Record record = { 0 };
+    if (vref_count > 0)
+    {
+        record.vref_raw = (int32_t)(vref_sum / vref_count);
+    }
+    record.unsettled = unsettled;
+    record.count     = 1;
+    for (uint16_t i = 0; i < block->Count; i++)
+    {
+        if (block->Tag[i] != ADS1220_SCAN_BRIDGE)
+        {
+            continue;  // The excitation monitor, auxiliary and settling slots
+        }
+        record.raw       = ads1220_correct(block->Data[i]) - drift;
+        record.timestamp = block->Timestamp[i];
+        ads1220_records.push(record);
+        record.unsettled = 0;
+    }
+    #else
+    Ads1220Record record = { 0 };
+    record.count = 1;
+    for (uint16_t i = 0; i < block->Count; i++)
+    {
+        if (block->Tag[i] & (ADS1220_TAG_AUX | ADS1220_TAG_UNSETTLED))
+        {
+            continue;  // Shorted-input, temperature and AVDD slots, the read after a failed switch
+        }
+        record.raw       = ads1220_correct(block->Data[i]) - drift;
+        record.timestamp = block->Timestamp[i];
+        ads1220_records.push(record);
+    }
+    #endif
+}
+
+void ads1220_init(void)
+{
     loadcell_ads1220.SendResetCommand();
     ThisThread::sleep_for(1);
-    loadcell_ads1220.Config();
+    #ifdef ADS1220_BURST
+    ADS1220BridgeBurst::Apply(loadcell_ads1220);
+    if (loadcell_ads1220.Verify() != ADS1220_NO_ERROR)
+    {
+        tr_debug("ADS1220 configuration mismatch\r\n");
+    }
+    loadcell_ads1220.SendShutdownCommand();  // Until the first reporting window
+
+    // The burst has to be done before the uplink: conversions plus margin ahead of it
+    uint32_t lead_ms = ADS1220_BURST_COUNT * 1000 / loadcell_ads1220.GetSampleRate() + ADS1220_BURST_MARGIN_MS;
+    tr_debug("ADS1220 bursts of %d conversions at %d SPS, %lus before each uplink every %ds\r\n",
+        ADS1220_BURST_COUNT, loadcell_ads1220.GetSampleRate(), lead_ms / 1000, MBED_CONF_APP_ADS1220_REPORT_PERIOD_S);
+    ads1220_thread.start(callback(&ads1220_queue, &EventQueue::dispatch_forever));
+    lrw_set_period(ADS1220_PERIOD_MS, ads1220_before_uplink, lead_ms);
+    return;
+    #endif
+
+    #ifdef ADS1220_TURBO
+    ADS1220BridgeTurbo::Apply(loadcell_ads1220);
+    ads1220_decimator.Attach(ads1220_decimated);
+    tr_debug("ADS1220 turbo %d SPS, decimated to %d Hz\r\n", loadcell_ads1220.GetSampleRate(), ADS1220_OUTPUT_HZ);
+    #else
+    ADS1220Bridge::Apply(loadcell_ads1220);
+    #endif
+    if (loadcell_ads1220.Verify() != ADS1220_NO_ERROR)  // One RREG burst against the shadow
+    {
+        tr_debug("ADS1220 configuration mismatch\r\n");
+    }
     ThisThread::sleep_for(1);
+
+    #ifdef ADS1220_SCAN
+    loadcell_ads1220.SetScan(ads1220_scan, 2);
+    #endif
+    #ifdef ADS1220_AUX
+    ads1220_aux.SetTemperatureCoefficient(MBED_CONF_APP_ADS1220_TEMPCO_PPM, ADS1220_TEMP_REF_C);
+    ads1220_aux.SetExcitationCorrection(!ADS1220_RATIOMETRIC, ADS1220_VREF);
+    #endif
+
+    // Continuous mode: 24 SCLKs per conversion, no RDATA
+    loadcell_ads1220.SetDirectRead(true);
+    #if defined(MBED_CONF_APP_ADS1220_DRDY_ON_DOUT) && MBED_CONF_APP_ADS1220_DRDY_ON_DOUT == 1
+    loadcell_ads1220.SetDRDYOnDout(true);
+    #endif
+
+    // Every conversion is read on DRDY and handed to the main loop with its timestamp
+    ads1220_thread.start(callback(&ads1220_queue, &EventQueue::dispatch_forever));
+    loadcell_ads1220.StartStream(&ads1220_queue, ads1220_block_done);
     loadcell_ads1220.SendStartCommand();
 }
 
-void ads1220_read(void)
+const LoadCellCalibration ads1220_calibration = { ADS1220_CAL_OFFSET, ADS1220_CAL_SCALE, LSB_SIZE(ADS1220_PGA, ADS1220_VREF) };
+
+class Ads1220LoadCell : public LoadCellAdcBase<Ads1220LoadCell>
 {
-    ads1220_sample.raw       = loadcell_ads1220.ReadData();
-    ads1220_sample.volt      = ads1220_sample.raw * LSB_SIZE(ADS1220_PGA, ADS1220_VREF);
-    ads1220_sample.mass      = (ads1220_sample.raw - ads1220_sample.offset) * ads1220_sample.scale;
-    ads1220_sample.available = false;
-}
+public:
+    Ads1220LoadCell() :
+        LoadCellAdcBase<Ads1220LoadCell>("ADS1220", ads1220_calibration),
+        unsettled_(0) {
+        memset(&record_, 0, sizeof(record_));
+    }
+
+    void start_adc(void) { ads1220_init(); }
+
+    LoadCellStatus read_adc(LoadCellReading *reading)
+    {
+        Ads1220Record record;
+
+        if (!ads1220_records.pop(&record))
+            return LOADCELL_NO_DATA;
+
+        unsettled_ += record.unsettled;
+        record_ = record;  // The newest one for the diagnostics
+        set_raw(reading, (LoadCellRaw)record.raw, record.count, record.timestamp);
+        return LOADCELL_OK;
+    }
+
+    void trace_adc(uint16_t n, LoadCellStatus status)
+    {
+        if (status != LOADCELL_OK)
+        {
+            return;
+        }
+        tr_debug("[%d] ADS1220: %lu conversions lost, %lu records dropped\r\n", n,
+            loadcell_ads1220.GetStreamOverruns(),
+            ads1220_records.get_overrun_count()
+            );
+        #ifdef ADS1220_BURST
+        tr_debug("[%d] ADS1220: burst %lums, duty cycle %.3f%%, ~%.1fuA average\r\n", n,
+            loadcell_ads1220.GetBurstTimeUs() / 1000,
+            record_.duty * 100,
+            record_.current_ua
+            );
+        #endif
+        #ifdef ADS1220_OFFSET_TRACK
+        tr_debug("[%d] ADS1220: offset %ld (%lu shorted-input conv), drift %ld removed\r\n", n,
+            ads1220_offset.GetOffset(),
+            ads1220_offset.GetSampleCount(),
+            ads1220_offset_drift()
+            );
+        #endif
+        #ifdef ADS1220_AUX
+        if (ads1220_aux.IsValid())
+        {
+            #if ADS1220_RATIOMETRIC
+            tr_debug("[%d] ADS1220: %.2fdegC\r\n", n,
+                ads1220_aux.GetTemperature()
+                );
+            #else
+            tr_debug("[%d] ADS1220: %.2fdegC, AVDD=%.3fV\r\n", n,
+                ads1220_aux.GetTemperature(),
+                ads1220_aux.GetAvdd()
+                );
+            #endif
+        }
+        #endif
+        #ifdef ADS1220_SCAN
+        tr_debug("[%d] ADS1220: excitation=%.3fV (%u settling conv dropped)\r\n", n,
+            record_.vref_raw * 4 * LSB_SIZE(1, ADS1220_VREF_INTERNAL),
+            unsettled_
+            );
+        unsettled_ = 0;
+        #endif
+    }
+
+private:
+    Ads1220Record record_;  // Diagnostics of the last read
+    uint16_t unsettled_;  // Scan: settling conversions since the previous trace
+};
+Ads1220LoadCell ads1220_loadcell;
 
 #endif
 
@@ -347,6 +967,128 @@ void print_memory_info() {
 }
 
 
+/******************************************************************************
+ * Load cell pipeline, the same for every converter
+ ******************************************************************************/
+#if defined(__ADC_ALL__)
+// HX711, ADS1232 and ADS1220 each read out on their own thread: none waits for another
+LoadCellAdcVirtual<Hx711LoadCell>   hx711_any(hx711_loadcell);
+LoadCellAdcVirtual<Ads1232LoadCell> ads1232_any(ads1232_loadcell);
+LoadCellAdcVirtual<Ads1220LoadCell> ads1220_any(ads1220_loadcell);
+static LoadCellAdc *const loadcells[] = { &hx711_any, &ads1232_any, &ads1220_any };
+#define LOADCELL_RECORDS (HX711_RECORDS + ADS1232_RECORDS + ADS1220_RECORDS)
+#elif defined(__HX711__)
+static Hx711LoadCell *const loadcells[] = { &hx711_loadcell };
+#define LOADCELL_RECORDS HX711_RECORDS
+#elif defined(__ADS1232__)
+static Ads1232LoadCell *const loadcells[] = { &ads1232_loadcell };
+#define LOADCELL_RECORDS ADS1232_RECORDS
+#elif defined(__ADS1220__)
+static Ads1220LoadCell *const loadcells[] = { &ads1220_loadcell };
+#define LOADCELL_RECORDS ADS1220_RECORDS
+#endif
+#define LOADCELL_SOURCES (sizeof(loadcells) / sizeof(loadcells[0]))
+
+// A record of the merged stream, tagged with the loadcells[] index of its converter
+typedef struct {
+    uint8_t source;
+    LoadCellReading reading;
+} LoadCellRecord;
+
+// Oldest first; the us_ticker wraps, so by difference. Every converter's
+// records come in order already, so each one only moves past the records of
+// the other converters that are newer
+static void loadcell_merge(LoadCellRecord *records, uint16_t count)
+{
+    for (uint16_t i = 1; i < count; i++)
+    {
+        LoadCellRecord record = records[i];
+        uint16_t j = i;
+
+        while (j > 0 && (int32_t)(record.reading.timestamp - records[j - 1].reading.timestamp) < 0)
+        {
+            records[j] = records[j - 1];
+            j--;
+        }
+        records[j] = record;
+    }
+}
+
+#ifdef __OLED__
+// Mass of the mean of count fine codes; the mass is linear in the code, so the
+// sum stays exact and is divided once
+static float loadcell_mean_mass(const LoadCellCalibration &calibration, int64_t fine_sum, uint32_t count)
+{
+    int64_t offset = (int64_t)calibration.offset * (1 << LOADCELL_FRAC_BITS) * count;
+
+    return (float)((double)(fine_sum - offset) / ((double)count * (1 << LOADCELL_FRAC_BITS))) * calibration.scale;
+}
+#endif
+
+// Static dispatch on an adapter, virtual on a LoadCellAdc. Appends every record
+// the converter has, up to room, tagged with source; returns how many
+template <class Adc>
+static uint16_t loadcell_drain(Adc &adc, uint8_t source, uint16_t n, LoadCellRecord *records, uint16_t room)
+{
+    LoadCellStatus status = LOADCELL_NO_DATA;
+    LoadCellStatus traced = LOADCELL_NO_DATA;  // LOADCELL_OK once a record counts
+    uint16_t count = 0;
+
+    // A failed record ends the pass for this converter, the ones after it come next pass
+    while (count < room)
+    {
+        status = adc.read(&records[count].reading);
+        if (status == LOADCELL_OK)
+        {
+            records[count++].source = source;
+            traced = LOADCELL_OK;
+            continue;
+        }
+        if (status != LOADCELL_DISCARDED)
+        {
+            break;
+        }
+        tr_debug("[%d] %s: raw=%ld n=%u mass=%.3fg discarded\r\n", n, adc.name(),
+            records[count].reading.raw,
+            records[count].reading.count,
+            records[count].reading.mass
+            );
+        if (traced != LOADCELL_OK)
+        {
+            traced = LOADCELL_DISCARDED;
+        }
+    }
+    if (status != LOADCELL_OK && status != LOADCELL_DISCARDED && status != LOADCELL_NO_DATA && status != LOADCELL_CALIBRATING)
+    {
+        tr_debug("%s: %s\r\n", adc.name(), loadcell_status_text(status));
+    }
+    adc.trace(n, (traced != LOADCELL_NO_DATA) ? traced : status);
+
+    return count;
+}
+
+#ifdef __BENCHMARK__
+static void loadcell_benchmark(void)
+{
+    benchmark_init();
+    #ifdef __HX711__
+    benchmark_hx711_transport(loadcell_hx711, HX711_TRANSPORT);
+    {
+        FastHx711<P_8, P_9> loadcell_fast(HX711_CAL_OFFSET, HX711_CAL_SCALE, HX711_PGA);
+        benchmark_hx711_fast(loadcell_hx711, loadcell_fast);
+    }
+    #endif
+    #ifdef __ADS1232__
+    benchmark_ads1232_transport(loadcell_ads1232, ADS1232_TRANSPORT);
+    #endif
+    #ifdef __ADS1220__
+    benchmark_ads1220_read(loadcell_ads1220);
+    benchmark_ads1220_decimator();
+    #endif
+}
+#endif
+
+
 /******************************************************************************
  * Main
  ******************************************************************************/
@@ -359,7 +1101,8 @@ int main()
     lrw_init();
     print_memory_info();
 
-    float raw = 0;
+    int64_t raw[LOADCELL_SOURCES] = { 0 };  // Codes summed over the run, divided once at the end
+    uint32_t raw_count[LOADCELL_SOURCES] = { 0 };
 
     ThisThread::sleep_for(1000);  // Delay for showing splash
 
@@ -375,16 +1118,15 @@ int main()
     //#endif
 
 
-    #ifdef __HX711__
-    hx711_init();
-    #endif
-    #ifdef __ADS1232__
-    ads1232_init();
-    #endif
-    #ifdef __ADS1220__
-    ads1220_init();
+    #ifdef __BENCHMARK__
+    loadcell_benchmark();
     #endif
 
+    for (uint8_t i = 0; i < LOADCELL_SOURCES; i++)
+    {
+        loadcells[i]->start();
+    }
+
 
     tr_debug("----------------------------------------\r\n");
 
@@ -415,7 +1157,8 @@ int main()
             //
 
                 sample_count = 0;
-                raw = 0;
+                memset(raw, 0, sizeof(raw));
+                memset(raw_count, 0, sizeof(raw_count));
                 tr_debug("----------------------------------------\r\n");
 
 
@@ -425,7 +1168,11 @@ int main()
         if (++sample_count > TEST_AMOUNT)
         {
             #ifdef __OLED__
-            gOled2.printf("\r\n   raw:%.1f\r\n", raw/TEST_AMOUNT);
+            gOled2.printf("\r\n");
+            for (uint8_t i = 0; i < LOADCELL_SOURCES; i++)
+            {
+                gOled2.printf("   raw:%.1f\r\n", raw_count[i] ? (double)raw[i] / raw_count[i] : 0.);
+            }
             gOled2.printf("   -- Finish --  \r\n");
             gOled2.display();
             #endif
@@ -435,62 +1182,53 @@ int main()
         }
 
 
-        #ifdef __OLED__
-        gOled2.clearDisplay();
-        gOled2.setTextCursor(0, 0);
-        #endif
-
-
-        #ifdef __HX711__
-        tr_debug("[%d] HX711: raw=%ld volt=%.3fmV mass=%.3fg\r\n", sample_count,
-            hx711_sample.raw,
-            hx711_sample.volt * 1000,
-            hx711_sample.mass
-            );
-        raw += hx711_sample.raw;
-        #ifdef __OLED__
-        gOled2.printf("%u:HX711 %.2fg\r\n", sample_count, hx711_sample.mass);
-        gOled2.display();
-        #endif
-        #endif
-
-
-        #ifdef __ADS1232__
-        if (ads1232_sample.status == ADS1231::ADS1231_status_t::ADS1231_FAILURE)
+        // Every record each converter produced since the last pass, as one time-ordered stream
+        static LoadCellRecord records[LOADCELL_RECORDS];  // Not on the main stack
+        uint16_t count = 0;
+        for (uint8_t i = 0; i < LOADCELL_SOURCES; i++)
         {
-            tr_debug("ADS1232 fail on readRaw()\r\n");
+            count += loadcell_drain(*loadcells[i], i, sample_count, &records[count], LOADCELL_RECORDS - count);
         }
-        else
+        if (count == 0)
         {
-            tr_debug("[%d] ADS1232: raw=%ld volt=%.3fmV mass=%.3fg\r\n", sample_count,
-                ads1232_sample.count.myRawValue,
-                ads1232_sample.calculated_volt.myVoltage * 1000,
-                ads1232_sample.calculated_mass.myMass  // ADS1231::ADS1231_SCALE_g
-                );
-            raw += ads1232_sample.count.myRawValue;
-            #ifdef __OLED__
-            gOled2.printf("%u:1232 %.2fg\r\n", sample_count, ads1232_sample.calculated_mass.myMass);
-            gOled2.display();
-            #endif
+            sample_count--;  // The test run counts complete readings only
+            continue;
         }
-        #endif
-
+        loadcell_merge(records, count);
 
-        #ifdef __ADS1220__
-        if (ads1220_sample.available)
+        int64_t fine[LOADCELL_SOURCES] = { 0 };
+        uint32_t fine_count[LOADCELL_SOURCES] = { 0 };
+        for (uint16_t i = 0; i < count; i++)
         {
-            ads1220_read();
-            tr_debug("[%d] ADS1220: raw=%ld volt=%.3fmV mass=%.3fg\r\n", sample_count,
-                ads1220_sample.raw,
-                ads1220_sample.volt * 1000,
-                ads1220_sample.mass
+            const LoadCellRecord &record = records[i];
+
+            tr_debug("[%d] t=%lu %s: raw=%ld n=%u volt=%.3fmV mass=%.3fg\r\n", sample_count,
+                record.reading.timestamp,
+                loadcells[record.source]->name(),
+                record.reading.raw,
+                record.reading.count,
+                record.reading.volt * 1000,
+                record.reading.mass
                 );
-            raw += ads1220_sample.raw;
-            #ifdef __OLED__
-            gOled2.printf("%u:1220 %.2fg\r\n", sample_count, ads1220_sample.mass);
-            gOled2.display();
-            #endif
+            raw[record.source] += record.reading.raw;
+            raw_count[record.source]++;
+            fine[record.source] += record.reading.fine;
+            fine_count[record.source]++;
+        }
+
+        #ifdef __OLED__
+        // The summary only: the mean of each converter over this pass
+        gOled2.clearDisplay();
+        gOled2.setTextCursor(0, 0);
+        for (uint8_t i = 0; i < LOADCELL_SOURCES; i++)
+        {
+            if (fine_count[i] > 0)
+            {
+                gOled2.printf("%u:%s %.2fg\r\n", sample_count, loadcells[i]->name(),
+                    loadcell_mean_mass(loadcells[i]->get_calibration(), fine[i], fine_count[i]));
+            }
         }
+        gOled2.display();
         #endif
     }
 }
@@ -0,0 +1,20 @@
+#!/bin/bash
+# Builds and runs the driver tests on the host, against test/host/mbed.h.
+
+BUILD_PATH="${TMPDIR:-/tmp}/host_tests"
+CXX="${CXX:-g++}"
+CXXFLAGS="-std=gnu++14 -Wall -O2 -pthread -Itest/host -IHX711 -ISpiBitstream -I."
+
+mkdir -p "${BUILD_PATH}"
+status=0
+
+run_test() {
+    name=$1
+    shift
+    ${CXX} ${CXXFLAGS} "test/host/${name}.cpp" "$@" -o "${BUILD_PATH}/${name}" && "${BUILD_PATH}/${name}" || status=1
+}
+
+run_test test_hx711_multi HX711/Hx711Multi.cpp HX711/Hx711.cpp
+run_test test_spsc_queue
+
+exit ${status}
@@ -0,0 +1,103 @@
+#ifndef __SPSC_QUEUE_H__
+#define __SPSC_QUEUE_H__
+
+#include "mbed.h"
+
+
+/******************************************************************************
+ * Wait-free single-producer / single-consumer queue
+ *
+ * One context (an ISR, or a thread) calls push() and one other calls pop();
+ * neither ever waits or masks interrupts. The records live in the object, so
+ * a global queue is static storage with no heap.
+ *
+ * head_ and tail_ are free-running counters, masked on access: all Capacity
+ * slots are used and head_ - tail_ is the fill level across the wrap. The
+ * producer copies the record into its slot, then publishes head_ with release
+ * ordering; the consumer reads head_ with acquire ordering before it copies
+ * the slot out and hands it back through tail_ the same way. A record is
+ * therefore seen whole or not at all.
+ *
+ * A push() onto a full queue drops the new record and counts it.
+ ******************************************************************************/
+template <typename T, uint32_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscQueue: the capacity must be a power of two");
+
+public:
+    SpscQueue() :
+        head_(0),
+        tail_(0),
+        overruns_(0) {
+    }
+
+    /**
+     * Append a record; producer side only
+     * @return false if the queue was full, the record is dropped and counted
+     */
+    bool push(const T &record)
+    {
+        uint32_t head = head_;  // Only written here
+        uint32_t tail = core_util_atomic_load_explicit_u32(&tail_, mbed_memory_order_acquire);
+
+        if (head - tail == Capacity)
+        {
+            core_util_atomic_store_explicit_u32(&overruns_, overruns_ + 1, mbed_memory_order_relaxed);
+            return false;
+        }
+
+        buffer_[head & (Capacity - 1)] = record;
+        core_util_atomic_store_explicit_u32(&head_, head + 1, mbed_memory_order_release);
+        return true;
+    }
+
+    /**
+     * Take the oldest record; consumer side only
+     * @return false if the queue is empty
+     */
+    bool pop(T *record)
+    {
+        uint32_t tail = tail_;  // Only written here
+        uint32_t head = core_util_atomic_load_explicit_u32(&head_, mbed_memory_order_acquire);
+
+        if (head == tail)
+        {
+            return false;
+        }
+
+        *record = buffer_[tail & (Capacity - 1)];
+        core_util_atomic_store_explicit_u32(&tail_, tail + 1, mbed_memory_order_release);
+        return true;
+    }
+
+    /**
+     * Records waiting; exact on the consumer side, a snapshot anywhere else
+     */
+    uint32_t size(void) const
+    {
+        return core_util_atomic_load_explicit_u32(&head_, mbed_memory_order_acquire) -
+               core_util_atomic_load_explicit_u32(&tail_, mbed_memory_order_acquire);
+    }
+
+    bool empty(void) const { return size() == 0; }
+
+    static uint32_t capacity(void) { return Capacity; }
+
+    /**
+     * Records dropped on a full queue since construction
+     */
+    uint32_t get_overrun_count(void) const
+    {
+        return core_util_atomic_load_explicit_u32(&overruns_, mbed_memory_order_relaxed);
+    }
+
+private:
+    T buffer_[Capacity];
+    volatile uint32_t head_;        // Next slot to write, owned by the producer
+    volatile uint32_t tail_;        // Next slot to read, owned by the consumer
+    volatile uint32_t overruns_;    // Written by the producer only
+};
+
+
+#endif  // __SPSC_QUEUE_H__
@@ -0,0 +1,187 @@
+/* Host-side stand-in for the parts of mbed OS the driver tests compile against
+ *
+ * Only what HX711/, SpiBitstream.h and spsc_queue.h use. The GPIO port is
+ * scripted: host_gpio::load() sets up one frame of DOUT bits per clock pulse,
+ * every rising edge of a DigitalOut advances the frame and PortIn reads the
+ * bits of the current one, as the data lines do after each PD_SCK rising edge.
+ */
+#ifndef __HOST_MBED_H__
+#define __HOST_MBED_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+typedef int PinName;
+typedef int PortName;
+enum { NC = -1, PortA = 0, PortB = 1 };
+#define STM_PORT(X) (((uint32_t)(X) >> 4) & 0xF)
+#define STM_PIN(X)  ((uint32_t)(X) & 0xF)
+#define MBED_ASSERT(x) assert(x)
+
+
+/******************************************************************************
+ * Scripted GPIO port
+ ******************************************************************************/
+namespace host_gpio {
+
+static const int MAX_PULSES = 64;
+
+struct State {
+    uint32_t frames[MAX_PULSES];    // port value after each rising edge, frames[0] after the first
+    int pulses;                     // rising edges since load()
+};
+
+inline State &state() {
+    static State s;
+    return s;
+}
+
+// Frame by frame port values for the next read; DOUT is low (ready) until the first edge
+inline void load(const uint32_t *frames, int count) {
+    memset(state().frames, 0, sizeof(state().frames));
+    memcpy(state().frames, frames, count * sizeof(uint32_t));
+    state().pulses = 0;
+}
+
+inline int pulses() {
+    return state().pulses;
+}
+
+inline uint32_t port() {
+    int p = state().pulses;
+    return (p == 0 || p > MAX_PULSES) ? 0 : state().frames[p - 1];
+}
+
+}  // namespace host_gpio
+
+
+/******************************************************************************
+ * Drivers
+ ******************************************************************************/
+namespace mbed {
+
+template <typename F> class Callback;
+template <typename R, typename... A> class Callback<R(A...)> {
+public:
+    Callback() : f_(NULL) {}
+    Callback(R (*f)(A...)) : f_(f) {}
+    template <typename T, typename M> Callback(T *obj, M method) : f_(NULL) {}
+    R operator()(A... a) const { return f_(a...); }
+    explicit operator bool() const { return f_ != NULL; }
+private:
+    R (*f_)(A...);
+};
+template <typename T, typename M> Callback<void()> callback(T *obj, M method) { return Callback<void()>(obj, method); }
+
+class DigitalOut {
+public:
+    DigitalOut(PinName pin, int value = 0) : pin_(pin), value_(value) {}
+    void write(int value) {
+        if (value && !value_) {
+            host_gpio::state().pulses++;
+        }
+        value_ = value;
+    }
+    int read() { return value_; }
+    int is_connected() { return pin_ != NC; }
+    DigitalOut &operator=(int value) { write(value); return *this; }
+    operator int() { return value_; }
+private:
+    PinName pin_;
+    int value_;
+};
+
+class InterruptIn {
+public:
+    InterruptIn(PinName pin) : pin_(pin) {}
+    int read() { return (host_gpio::port() >> STM_PIN(pin_)) & 1; }
+    operator int() { return read(); }
+    void fall(Callback<void()> cb) {}
+    void rise(Callback<void()> cb) {}
+    void enable_irq() {}
+    void disable_irq() {}
+private:
+    PinName pin_;
+};
+
+class PortIn {
+public:
+    PortIn(PortName port, int mask = 0xffffffff) : mask_(mask) {}
+    int read() { return host_gpio::port() & mask_; }
+private:
+    int mask_;
+};
+
+class SPI {
+public:
+    SPI(PinName mosi, PinName miso, PinName sclk) {}
+    void frequency(int hz) {}
+    void format(int bits, int mode = 0) {}
+    int write(int value) { return 0; }
+    int write(const char *tx, int tx_length, char *rx, int rx_length) { return 0; }
+};
+
+}  // namespace mbed
+using namespace mbed;
+
+namespace events {
+
+// Runs nothing: the tests read with readRaw(), not through the acquisition
+class EventQueue {
+public:
+    template <typename T, typename M, typename... A> int call(T *obj, M method, A... a) { return 0; }
+};
+
+}  // namespace events
+using namespace events;
+
+namespace rtos {
+
+class Mutex {
+public:
+    void lock() {}
+    void unlock() {}
+};
+
+}  // namespace rtos
+using namespace rtos;
+
+
+/******************************************************************************
+ * Platform
+ ******************************************************************************/
+typedef enum {
+    mbed_memory_order_relaxed = __ATOMIC_RELAXED,
+    mbed_memory_order_acquire = __ATOMIC_ACQUIRE,
+    mbed_memory_order_release = __ATOMIC_RELEASE,
+    mbed_memory_order_seq_cst = __ATOMIC_SEQ_CST
+} mbed_memory_order;
+
+inline uint32_t core_util_atomic_load_explicit_u32(const volatile uint32_t *ptr, mbed_memory_order order) {
+    return __atomic_load_n(ptr, order);
+}
+inline void core_util_atomic_store_explicit_u32(volatile uint32_t *ptr, uint32_t value, mbed_memory_order order) {
+    __atomic_store_n(ptr, value, order);
+}
+
+inline void core_util_critical_section_enter() {}
+inline void core_util_critical_section_exit() {}
+inline bool core_util_is_isr_active() { return false; }
+inline bool core_util_in_critical_section() { return false; }
+inline uint32_t us_ticker_read() { return 0; }
+inline void wait_us(int us) {}
+
+typedef struct { volatile uint32_t CTRL, CYCCNT; } DWT_Type;
+typedef struct { volatile uint32_t DEMCR; } CoreDebug_Type;
+inline DWT_Type *host_dwt() { static DWT_Type dwt; return &dwt; }
+inline CoreDebug_Type *host_core_debug() { static CoreDebug_Type core_debug; return &core_debug; }
+#define DWT (host_dwt())
+#define CoreDebug (host_core_debug())
+#define DWT_CTRL_CYCCNTENA_Msk 1
+#define CoreDebug_DEMCR_TRCENA_Msk (1 << 24)
+static const uint32_t SystemCoreClock = 32000000;
+
+#endif  // __HOST_MBED_H__
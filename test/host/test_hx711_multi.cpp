@@ -0,0 +1,149 @@
+/* Hx711Multi on a scripted GPIO port
+ *
+ * Several HX711 channels on one port: every channel shifts out its own 24-bit
+ * code, MSB first, on its own bit of the port. The test checks the codes each
+ * channel gets back, their sign extension, the clock pulses per frame, and
+ * that a frame a chip did not release DOUT after is counted and read again.
+ */
+#include "mbed.h"
+#include "Hx711.h"
+#include "Hx711Multi.h"
+
+// The transport is never attached in these tests
+SpiBitstream::SpiBitstream(PinName pin_clk, PinName pin_data, PinName pin_spi_sclk, int hz) :
+    spi_(pin_clk, pin_data, pin_spi_sclk) {}
+uint32_t SpiBitstream::read(uint8_t pulses, uint8_t bits) { return 0; }
+void SpiBitstream::release() {}
+
+static int failures = 0;
+
+#define CHECK_EQUAL(expected, actual, what, index) do { \
+        long long e_ = (expected), a_ = (actual); \
+        if (e_ != a_) { \
+            printf("FAIL %s[%d]: expected %lld, got %lld\n", what, (int)(index), e_, a_); \
+            failures++; \
+        } \
+    } while (0)
+
+// Interleave one 24-bit word per channel into per-pulse port values from
+// frames[0] on; the gain pulses after them see every DOUT high, as the chip
+// releases it after the 25th pulse, unless the frame is to be corrupted
+static void fill_words(uint32_t *frames, const uint32_t *words, const uint8_t *bits, uint8_t count,
+                       int pulses, bool released)
+{
+    for (uint8_t i = 0; i < 24; i++) {
+        for (uint8_t ch = 0; ch < count; ch++) {
+            frames[i] |= ((words[ch] >> (23 - i)) & 1) << bits[ch];
+        }
+    }
+    for (int i = 24; i < pulses && released; i++) {
+        for (uint8_t ch = 0; ch < count; ch++) {
+            frames[i] |= 1UL << bits[ch];
+        }
+    }
+}
+
+static void load_words(const uint32_t *words, const uint8_t *bits, uint8_t count)
+{
+    uint32_t frames[host_gpio::MAX_PULSES] = { 0 };
+
+    fill_words(frames, words, bits, count, host_gpio::MAX_PULSES, true);
+    host_gpio::load(frames, host_gpio::MAX_PULSES);
+}
+
+// Hx711::readRaw() convention: the sign-extended code, negated as in the library
+// this driver was ported from; -2^23 has no positive counterpart and stays as is
+static int32_t expected_code(uint32_t word)
+{
+    int32_t code = (word & 0x800000) ? (int32_t)(word | 0xff000000) : (int32_t)word;
+    return (code == -0x800000) ? code : -code;
+}
+
+static void test_transpose(void)
+{
+    static const uint8_t bits[HX711_MULTI_MAX_CHANNELS] = { 0, 5, 9, 15 };
+    static const uint32_t words[][HX711_MULTI_MAX_CHANNELS] = {
+        { 0x000000, 0x7fffff, 0x800000, 0xffffff },     // zero, full scale, most negative, -1
+        { 0x123456, 0xabcdef, 0x000001, 0xfffffe },
+        { 0x555555, 0xaaaaaa, 0x0f0f0f, 0xf0f0f0 },     // neighbouring bits toggling
+    };
+
+    for (size_t t = 0; t < sizeof(words) / sizeof(words[0]); t++) {
+        uint32_t frames[24] = { 0 };
+        int32_t codes[HX711_MULTI_MAX_CHANNELS];
+
+        for (uint8_t i = 0; i < 24; i++) {
+            for (uint8_t ch = 0; ch < HX711_MULTI_MAX_CHANNELS; ch++) {
+                frames[i] |= ((words[t][ch] >> (23 - i)) & 1) << bits[ch];
+            }
+            frames[i] |= 0xffff0000;  // pins of other users of the port
+        }
+
+        Hx711Multi::transpose(frames, bits, HX711_MULTI_MAX_CHANNELS, codes);
+        for (uint8_t ch = 0; ch < HX711_MULTI_MAX_CHANNELS; ch++) {
+            CHECK_EQUAL(expected_code(words[t][ch]), codes[ch], "transpose", t * 10 + ch);
+        }
+    }
+}
+
+static void test_read(void)
+{
+    static const PinName pins[3] = { 0x12, 0x13, 0x1a };     // PB_2, PB_3, PB_10
+    static const uint8_t bits[3] = { 2, 3, 10 };
+    static const uint32_t words[3] = { 0x00abcd, 0xfedcba, 0x800001 };
+    static const struct { uint8_t gain; int pulses; } gains[] = { { 128, 25 }, { 32, 26 }, { 64, 27 } };
+
+    load_words(words, bits, 3);     // The frame the constructor clocks out
+    Hx711Multi multi(0x20, PortB, pins, 3);
+
+    for (size_t g = 0; g < sizeof(gains) / sizeof(gains[0]); g++) {
+        int32_t codes[3];
+
+        load_words(words, bits, 3);
+        multi.set_gain(gains[g].gain);  // Clocks out one frame with the previous gain
+        load_words(words, bits, 3);
+        multi.readRaw(codes);
+
+        CHECK_EQUAL(gains[g].pulses, host_gpio::pulses(), "pulses", g);
+        for (uint8_t ch = 0; ch < 3; ch++) {
+            CHECK_EQUAL(expected_code(words[ch]), codes[ch], "read", g * 10 + ch);
+        }
+    }
+}
+
+static void test_corrupted(void)
+{
+    static const PinName pins[2] = { 0x12, 0x13 };     // PB_2, PB_3
+    static const uint8_t bits[2] = { 2, 3 };
+    static const uint32_t lost[2] = { 0x111111, 0x222222 };
+    static const uint32_t words[2] = { 0x00abcd, 0xfedcba };
+
+    load_words(words, bits, 2);     // The frame the constructor clocks out
+    Hx711Multi multi(0x20, PortB, pins, 2);
+    uint32_t frames[host_gpio::MAX_PULSES] = { 0 };
+    int32_t codes[2];
+
+    // 24 bits and 1 gain pulse each; DOUT stays low after the first frame
+    fill_words(frames, lost, bits, 2, 25, false);
+    fill_words(frames + 25, words, bits, 2, host_gpio::MAX_PULSES - 25, true);
+    host_gpio::load(frames, host_gpio::MAX_PULSES);
+
+    uint32_t corrupted = multi.get_corrupted_count();
+    multi.readRaw(codes);
+
+    CHECK_EQUAL(50, host_gpio::pulses(), "pulses", 0);
+    CHECK_EQUAL(corrupted + 1, multi.get_corrupted_count(), "corrupted", 0);
+    for (uint8_t ch = 0; ch < 2; ch++) {
+        CHECK_EQUAL(expected_code(words[ch]), codes[ch], "retry", ch);
+    }
+}
+
+int main()
+{
+    test_transpose();
+    test_read();
+    test_corrupted();
+
+    printf("%s: test_hx711_multi\n", failures ? "FAIL" : "PASS");
+    return failures ? 1 : 0;
+}
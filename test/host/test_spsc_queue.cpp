@@ -0,0 +1,111 @@
+/* SpscQueue between two threads
+ *
+ * A producer thread pushes a sequence of numbered records while the consumer
+ * thread pops them: every record must come out once, in order and whole. A
+ * second case fills the queue and checks the overrun count.
+ */
+#include <thread>
+#include "mbed.h"
+#include "spsc_queue.h"
+
+static int failures = 0;
+
+#define CHECK_EQUAL(expected, actual, what) do { \
+        long long e_ = (expected), a_ = (actual); \
+        if (e_ != a_) { \
+            printf("FAIL %s: expected %lld, got %lld\n", what, e_, a_); \
+            failures++; \
+        } \
+    } while (0)
+
+#define ITEMS 4000000u
+
+// Several words, so a torn copy shows up as a mismatch
+typedef struct {
+    uint32_t seq;
+    uint32_t check;
+    uint64_t wide;
+} Record;
+
+static void test_threads(void)
+{
+    static SpscQueue<Record, 64> queue;
+    uint32_t pushed = 0;
+    uint32_t retries = 0;
+
+    std::thread producer([&]() {
+        for (uint32_t seq = 0; seq < ITEMS; seq++) {
+            Record r = { seq, ~seq, ((uint64_t)seq << 32) | seq };
+
+            while (!queue.push(r)) {
+                retries++;
+                std::this_thread::yield();
+            }
+            pushed++;
+        }
+    });
+
+    uint32_t expected = 0;
+    uint32_t bad = 0;
+
+    while (expected < ITEMS) {
+        Record r;
+
+        if (!queue.pop(&r)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (r.seq != expected || r.check != ~expected || r.wide != (((uint64_t)expected << 32) | expected)) {
+            if (bad++ < 5) {
+                printf("FAIL threads: record %u arrived as seq %u\n", expected, r.seq);
+            }
+            expected = r.seq;
+        }
+        expected++;
+    }
+    producer.join();
+
+    Record r;
+    CHECK_EQUAL(0, bad, "threads: out of order or torn records");
+    CHECK_EQUAL(ITEMS, pushed, "threads: pushed");
+    CHECK_EQUAL(0, queue.pop(&r), "threads: left over");
+    CHECK_EQUAL(retries, queue.get_overrun_count(), "threads: overruns");
+}
+
+static void test_overrun(void)
+{
+    SpscQueue<uint32_t, 8> queue;
+    uint32_t value = 0;
+
+    // Wrap the indexes first so the full test straddles the end of the buffer
+    for (uint32_t i = 0; i < 5; i++) {
+        queue.push(i);
+        queue.pop(&value);
+    }
+    for (uint32_t i = 0; i < 8; i++) {
+        CHECK_EQUAL(1, queue.push(100 + i), "overrun: push into room");
+    }
+    CHECK_EQUAL(8, queue.size(), "overrun: size when full");
+    for (uint32_t i = 0; i < 3; i++) {
+        CHECK_EQUAL(0, queue.push(200 + i), "overrun: push when full");
+    }
+    CHECK_EQUAL(3, queue.get_overrun_count(), "overrun: count");
+
+    // The dropped records are the new ones, the queued ones stay intact
+    for (uint32_t i = 0; i < 8; i++) {
+        CHECK_EQUAL(1, queue.pop(&value), "overrun: pop");
+        CHECK_EQUAL(100 + i, value, "overrun: value");
+    }
+    CHECK_EQUAL(1, queue.empty(), "overrun: empty");
+    CHECK_EQUAL(1, queue.push(300), "overrun: push after drain");
+    CHECK_EQUAL(3, queue.get_overrun_count(), "overrun: count after drain");
+}
+
+int main()
+{
+    test_overrun();
+    test_threads();
+
+    printf("%s: test_spsc_queue\n", failures ? "FAIL" : "PASS");
+    return failures ? 1 : 0;
+}